@@ -0,0 +1,122 @@
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../AudioSignature/AudioSignature.h"
+#include "FixtureWriter.h"
+
+using namespace AudioSignature;
+
+// The codecs of a typical library, each at a few lengths and channel
+// layouts.  MP3 and WMA top out at stereo.
+const Fixture Fixtures[] =
+{
+	{ { "libmp3lame", nullptr }, ".mp3", 2, 30 },
+	{ { "libmp3lame", nullptr }, ".mp3", 2, 240 },
+	{ { "libmp3lame", nullptr }, ".mp3", 1, 240 },
+	{ { "aac", nullptr }, ".m4a", 2, 30 },
+	{ { "aac", nullptr }, ".m4a", 2, 240 },
+	{ { "aac", nullptr }, ".m4a", 6, 240 },
+	{ { "flac", nullptr }, ".flac", 2, 30 },
+	{ { "flac", nullptr }, ".flac", 2, 240 },
+	{ { "flac", nullptr }, ".flac", 6, 240 },
+	{ { "alac", nullptr }, ".m4a", 2, 30 },
+	{ { "alac", nullptr }, ".m4a", 2, 240 },
+	{ { "wmav2", nullptr }, ".wma", 2, 30 },
+	{ { "wmav2", nullptr }, ".wma", 2, 240 },
+	{ { "libopus", "opus" }, ".opus", 2, 30 },
+	{ { "libopus", "opus" }, ".opus", 2, 240 }
+};
+
+void BenchmarkGetAudioSignature(benchmark::State& state, std::string path);
+double GetStatsAudioSeconds();
+
+// Writes any fixtures missing from the fixture directory, then registers
+// one benchmark per fixture.  Fixtures are kept between runs, as encoding
+// them takes far longer than fingerprinting them, and only appear once
+// complete.
+int main(int argc, char** argv)
+{
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "AudioSignatureBenchmarks";
+	std::filesystem::create_directories(directory);
+
+	InitializeLogging(-1, nullptr);
+
+	for (const Fixture& fixture : Fixtures)
+	{
+		std::string name = GetFixtureName(fixture);
+		std::filesystem::path path = directory / name;
+
+		if (!std::filesystem::exists(path))
+		{
+			std::string error = WriteFixture(fixture, path.string());
+
+			if (!error.empty())
+			{
+				std::cerr << "Skipping " << name << ": " << error <<
+					std::endl;
+
+				continue;
+			}
+		}
+
+		benchmark::RegisterBenchmark(
+			("GetAudioSignature/" + name).c_str(),
+			BenchmarkGetAudioSignature,
+			path.string())->Unit(benchmark::kMillisecond);
+	}
+
+	benchmark::Initialize(&argc, argv);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
+
+void BenchmarkGetAudioSignature(benchmark::State& state, std::string path)
+{
+	ResetAudioSignatureStats();
+
+	for (auto _ : state)
+	{
+		char* result = GetAudioSignature(path.c_str());
+
+		if (result == nullptr)
+		{
+			state.SkipWithError("Could not fingerprint the fixture");
+			break;
+		}
+
+		FreeAudioSignature(result);
+	}
+
+	// The stats know how much audio was actually decoded, which is less
+	// than the file for those longer than the default 120 seconds.
+	state.counters["files"] = benchmark::Counter(
+		static_cast<double>(state.iterations()),
+		benchmark::Counter::kIsRate);
+	state.counters["audio_seconds"] = benchmark::Counter(
+		GetStatsAudioSeconds(), benchmark::Counter::kIsRate);
+}
+
+double GetStatsAudioSeconds()
+{
+	double audioSeconds = 0.0;
+	size_t count = 0;
+
+	GetAudioSignatureStats(nullptr, 0, &count);
+
+	std::vector<SignatureStats> stats(count);
+	GetAudioSignatureStats(stats.data(), stats.size(), &count);
+
+	for (size_t index = 0; index < count; index++)
+	{
+		audioSeconds += stats[index].audioSeconds;
+	}
+
+	return audioSeconds;
+}
@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <numbers>
+#include <system_error>
+#include <vector>
+
+extern "C"
+{
+	#include <libavcodec/avcodec.h>
+	#include <libavformat/avformat.h>
+	#include <libswresample/swresample.h>
+}
+
+#include "FixtureWriter.h"
+
+namespace AudioSignature
+{
+	// Owns the FFmpeg state of one fixture being written.
+	struct FixtureEncoder
+	{
+		const AVCodec* codec = nullptr;
+		AVCodecContext* codecContext = nullptr;
+		AVFormatContext* formatContext = nullptr;
+		AVFrame* frame = nullptr;
+		AVPacket* packet = nullptr;
+		AVStream* stream = nullptr;
+		SwrContext* converter = nullptr;
+
+		~FixtureEncoder()
+		{
+			if (formatContext != nullptr &&
+				!(formatContext->oformat->flags & AVFMT_NOFILE))
+			{
+				avio_closep(&formatContext->pb);
+			}
+
+			swr_free(&converter);
+			av_packet_free(&packet);
+			av_frame_free(&frame);
+			avcodec_free_context(&codecContext);
+			avformat_free_context(formatContext);
+		}
+	};
+
+	std::string EncodeFixture(
+		const Fixture& fixture,
+		const std::string& path,
+		const std::string& temporaryPath);
+	void FillSamples(
+		std::vector<int16_t>& samples,
+		int channels,
+		int sampleRate,
+		int64_t position,
+		uint32_t& noise);
+	std::string OpenEncoder(
+		FixtureEncoder& encoder, const Fixture& fixture, int sampleRate);
+	int PickSampleRate(const AVCodec* codec);
+	std::string WritePackets(FixtureEncoder& encoder, AVFrame* frame);
+
+	std::string GetFixtureName(const Fixture& fixture)
+	{
+		std::string name = std::string(fixture.encoders[0]) + "-" +
+			std::to_string(fixture.channels) + "ch-" +
+			std::to_string(fixture.seconds) + "s" + fixture.extension;
+
+		return name;
+	}
+
+	std::string WriteFixture(const Fixture& fixture, const std::string& path)
+	{
+		// As the transcoder does, the fixture is written beside its path
+		// and renamed into place once complete, so that a run stopped
+		// part way never leaves a truncated fixture to be reused.
+		std::string temporaryPath = path + ".partial";
+
+		std::string error = EncodeFixture(fixture, path, temporaryPath);
+
+		if (error.empty())
+		{
+			std::error_code renameError;
+			std::filesystem::rename(temporaryPath, path, renameError);
+
+			if (renameError)
+			{
+				error = "Could not move the fixture into place: " +
+					renameError.message();
+			}
+		}
+
+		if (!error.empty())
+		{
+			std::error_code ignored;
+			std::filesystem::remove(temporaryPath, ignored);
+		}
+
+		return error;
+	}
+
+	std::string EncodeFixture(
+		const Fixture& fixture,
+		const std::string& path,
+		const std::string& temporaryPath)
+	{
+		FixtureEncoder encoder;
+
+		// The container is picked by the final path's extension.
+		const AVOutputFormat* format =
+			av_guess_format(nullptr, path.c_str(), nullptr);
+
+		int result = AVERROR_MUXER_NOT_FOUND;
+
+		if (format != nullptr)
+		{
+			result = avformat_alloc_output_context2(
+				&encoder.formatContext,
+				format,
+				nullptr,
+				temporaryPath.c_str());
+		}
+
+		if (result < 0)
+		{
+			return "No container for " + std::string(fixture.extension);
+		}
+
+		for (const char* name : fixture.encoders)
+		{
+			if (name != nullptr && encoder.codec == nullptr)
+			{
+				encoder.codec = avcodec_find_encoder_by_name(name);
+			}
+		}
+
+		if (encoder.codec == nullptr)
+		{
+			return "No encoder for " + std::string(fixture.encoders[0]);
+		}
+
+		int sampleRate = PickSampleRate(encoder.codec);
+		std::string error = OpenEncoder(encoder, fixture, sampleRate);
+
+		if (!error.empty())
+		{
+			return error;
+		}
+
+		// Encoders without a fixed frame size take any, so a common
+		// decoder block size is used.
+		int frameSize = encoder.codecContext->frame_size;
+
+		if (frameSize <= 0)
+		{
+			frameSize = 4096;
+		}
+
+		std::vector<int16_t> samples(
+			static_cast<size_t>(frameSize) * fixture.channels);
+		uint32_t noise = 12345;
+		int64_t total = static_cast<int64_t>(fixture.seconds) * sampleRate;
+
+		for (int64_t position = 0; position < total; position += frameSize)
+		{
+			int count = static_cast<int>(
+				std::min<int64_t>(frameSize, total - position));
+
+			FillSamples(
+				samples, fixture.channels, sampleRate, position, noise);
+
+			AVFrame* frame = encoder.frame;
+			frame->nb_samples = count;
+			frame->pts = position;
+
+			result = av_frame_make_writable(frame);
+
+			const uint8_t* input =
+				reinterpret_cast<const uint8_t*>(samples.data());
+
+			if (result >= 0)
+			{
+				result = swr_convert(
+					encoder.converter, frame->data, count, &input, count);
+			}
+
+			if (result < 0)
+			{
+				return "Could not convert the samples";
+			}
+
+			error = WritePackets(encoder, frame);
+
+			if (!error.empty())
+			{
+				return error;
+			}
+		}
+
+		error = WritePackets(encoder, nullptr);
+
+		if (error.empty() && av_write_trailer(encoder.formatContext) < 0)
+		{
+			error = "Could not finish the file";
+		}
+
+		return error;
+	}
+
+	void FillSamples(
+		std::vector<int16_t>& samples,
+		int channels,
+		int sampleRate,
+		int64_t position,
+		uint32_t& noise)
+	{
+		// A short repeating melody, so that the fingerprint has changing
+		// chroma to work on, with a little noise so that the lossless
+		// codecs cannot compress it away.
+		static const double notes[] =
+		{
+			261.63, 329.63, 392.00, 523.25, 440.00, 349.23, 293.66, 246.94
+		};
+
+		size_t frames = samples.size() / channels;
+
+		for (size_t index = 0; index < frames; index++)
+		{
+			int64_t sample = position + static_cast<int64_t>(index);
+			double time = static_cast<double>(sample) / sampleRate;
+
+			int note = static_cast<int>(time * 2.0) % 8;
+			double phase = 2.0 * std::numbers::pi * notes[note] * time;
+			double tone = 0.4 * std::sin(phase) + 0.2 * std::sin(phase * 2.0);
+
+			for (int channel = 0; channel < channels; channel++)
+			{
+				noise = noise * 1664525 + 1013904223;
+				double hiss = (static_cast<int>(noise >> 16) - 32768) / 32768.0;
+
+				// Each channel is a little different, as real mixes are.
+				double value = tone * (1.0 - 0.05 * channel) + 0.02 * hiss;
+
+				samples[index * channels + channel] =
+					static_cast<int16_t>(value * 32767.0);
+			}
+		}
+	}
+
+	std::string OpenEncoder(
+		FixtureEncoder& encoder, const Fixture& fixture, int sampleRate)
+	{
+		AVCodecContext* codecContext = avcodec_alloc_context3(encoder.codec);
+		encoder.codecContext = codecContext;
+
+		if (codecContext == nullptr)
+		{
+			return "Could not allocate the encoder";
+		}
+
+		codecContext->sample_rate = sampleRate;
+		codecContext->sample_fmt = encoder.codec->sample_fmts != nullptr ?
+			encoder.codec->sample_fmts[0] : AV_SAMPLE_FMT_S16;
+		codecContext->time_base = AVRational{ 1, sampleRate };
+		codecContext->strict_std_compliance = FF_COMPLIANCE_EXPERIMENTAL;
+		av_channel_layout_default(&codecContext->ch_layout, fixture.channels);
+
+		if (encoder.formatContext->oformat->flags & AVFMT_GLOBALHEADER)
+		{
+			codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+		}
+
+		int result = avcodec_open2(codecContext, encoder.codec, nullptr);
+
+		if (result < 0)
+		{
+			return "Could not open the " + std::string(encoder.codec->name) +
+				" encoder with " + std::to_string(fixture.channels) +
+				" channels";
+		}
+
+		encoder.stream = avformat_new_stream(encoder.formatContext, nullptr);
+
+		if (encoder.stream == nullptr)
+		{
+			return "Could not add the stream";
+		}
+
+		encoder.stream->time_base = codecContext->time_base;
+		avcodec_parameters_from_context(
+			encoder.stream->codecpar, codecContext);
+
+		AVChannelLayout inputLayout;
+		av_channel_layout_default(&inputLayout, fixture.channels);
+
+		result = swr_alloc_set_opts2(
+			&encoder.converter,
+			&codecContext->ch_layout,
+			codecContext->sample_fmt,
+			sampleRate,
+			&inputLayout,
+			AV_SAMPLE_FMT_S16,
+			sampleRate,
+			0,
+			nullptr);
+
+		av_channel_layout_uninit(&inputLayout);
+
+		if (result < 0 || swr_init(encoder.converter) < 0)
+		{
+			return "Could not set up the sample conversion";
+		}
+
+		encoder.frame = av_frame_alloc();
+		encoder.packet = av_packet_alloc();
+
+		if (encoder.frame == nullptr || encoder.packet == nullptr)
+		{
+			return "Could not allocate the encoding buffers";
+		}
+
+		int frameSize = codecContext->frame_size > 0 ?
+			codecContext->frame_size : 4096;
+
+		encoder.frame->format = codecContext->sample_fmt;
+		encoder.frame->sample_rate = sampleRate;
+		encoder.frame->nb_samples = frameSize;
+		av_channel_layout_copy(
+			&encoder.frame->ch_layout, &codecContext->ch_layout);
+
+		if (av_frame_get_buffer(encoder.frame, 0) < 0)
+		{
+			return "Could not allocate the frame";
+		}
+
+		const AVOutputFormat* format = encoder.formatContext->oformat;
+
+		if (!(format->flags & AVFMT_NOFILE) &&
+			avio_open(
+				&encoder.formatContext->pb,
+				encoder.formatContext->url,
+				AVIO_FLAG_WRITE) < 0)
+		{
+			return "Could not create the file";
+		}
+
+		if (avformat_write_header(encoder.formatContext, nullptr) < 0)
+		{
+			return "Could not write the header";
+		}
+
+		return std::string();
+	}
+
+	int PickSampleRate(const AVCodec* codec)
+	{
+		// CD rate where the encoder allows it, as most libraries are,
+		// otherwise the encoder's own first choice, such as Opus's 48k.
+		int sampleRate = 44100;
+
+		if (codec->supported_samplerates != nullptr)
+		{
+			sampleRate = codec->supported_samplerates[0];
+
+			for (const int* rate = codec->supported_samplerates;
+				*rate != 0;
+				rate++)
+			{
+				if (*rate == 44100)
+				{
+					sampleRate = 44100;
+				}
+			}
+		}
+
+		return sampleRate;
+	}
+
+	std::string WritePackets(FixtureEncoder& encoder, AVFrame* frame)
+	{
+		int result = avcodec_send_frame(encoder.codecContext, frame);
+
+		while (result >= 0)
+		{
+			result =
+				avcodec_receive_packet(encoder.codecContext, encoder.packet);
+
+			if (result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+			{
+				return std::string();
+			}
+
+			if (result >= 0)
+			{
+				av_packet_rescale_ts(
+					encoder.packet,
+					encoder.codecContext->time_base,
+					encoder.stream->time_base);
+				encoder.packet->stream_index = encoder.stream->index;
+
+				result = av_interleaved_write_frame(
+					encoder.formatContext, encoder.packet);
+			}
+		}
+
+		return "Could not encode the audio";
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+namespace AudioSignature
+{
+	// Describes a synthetic audio file to benchmark against.
+	struct Fixture
+	{
+		// The FFmpeg encoder names to try, in order of preference, as
+		// several codecs have both a native and an external encoder.
+		const char* encoders[2];
+
+		// The file extension, which also picks the container.
+		const char* extension;
+
+		int channels;
+		int seconds;
+	};
+
+	// Returns the file name of a fixture, naming its codec, channels and
+	// length, so that fixtures can be kept between runs.
+	std::string GetFixtureName(const Fixture& fixture);
+
+	// Encodes a fixture of tones and noise to the given path, returning
+	// an empty string on success, or the reason it could not be written.
+	// Nothing is left at the path unless the whole fixture was written.
+	std::string WriteFixture(const Fixture& fixture, const std::string& path);
+}
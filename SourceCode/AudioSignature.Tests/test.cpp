@@ -1,7 +1,19 @@
 #include "pch.h"
 
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <vector>
+
+extern "C"
+{
+	#include <libavformat/avformat.h>
+}
 
 #include "../AudioSignature/AudioSignature.h"
 
@@ -61,3 +73,1281 @@ TEST(TestAudioSignature, Correct)
 
 	ASSERT_STREQ(result, intended);
 }
+
+TEST(TestAudioSignatureAsync, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	std::promise<char*> promise;
+	std::future<char*> future = promise.get_future();
+
+	auto callback = [](int status, char* audioSignature, void* userData)
+	{
+		EXPECT_EQ(status, SignatureSuccess);
+
+		std::promise<char*>* promise =
+			static_cast<std::promise<char*>*>(userData);
+
+		promise->set_value(audioSignature);
+	};
+
+	int status = GetAudioSignatureAsync(
+		tempPath.c_str(), nullptr, callback, &promise);
+
+	ASSERT_EQ(status, SignatureSuccess);
+
+	char* asyncResult = future.get();
+	char* result = GetAudioSignature(tempPath.c_str());
+
+	ASSERT_NE(asyncResult, nullptr);
+	ASSERT_NE(result, nullptr);
+	EXPECT_STREQ(asyncResult, result);
+
+	FreeAudioSignature(asyncResult);
+	FreeAudioSignature(result);
+}
+
+TEST(TestAudioSignatures, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	const char* dataPaths[] =
+		{ tempPath.c_str(), "missing.mp4", tempPath.c_str() };
+	char* results[3];
+
+	int count = GetAudioSignatures(dataPaths, 3, results, 0);
+
+	EXPECT_EQ(count, 2);
+	EXPECT_NE(results[0], nullptr);
+	EXPECT_EQ(results[1], nullptr);
+	ASSERT_NE(results[2], nullptr);
+	ASSERT_STREQ(results[0], results[2]);
+
+	for (char* result : results)
+	{
+		FreeAudioSignature(result);
+	}
+}
+
+TEST(TestAudioSignatureBatch, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	const char* dataPaths[] =
+		{ tempPath.c_str(), "missing.mp4", tempPath.c_str() };
+	char** results = nullptr;
+
+	int count = GetAudioSignatureBatch(dataPaths, 3, 0, &results);
+
+	EXPECT_EQ(count, 2);
+	ASSERT_NE(results, nullptr);
+	EXPECT_NE(results[0], nullptr);
+	EXPECT_EQ(results[1], nullptr);
+	ASSERT_NE(results[2], nullptr);
+	ASSERT_STREQ(results[0], results[2]);
+
+	FreeAudioSignatureBatch(results);
+}
+
+TEST(TestSignatureSession, Reuse)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureSession* session = CreateSignatureSession();
+
+	ASSERT_NE(session, nullptr);
+
+	char* first = SignatureSessionRun(session, tempPath.c_str());
+	char* second = SignatureSessionRun(session, tempPath.c_str());
+
+	ASSERT_NE(first, nullptr);
+	ASSERT_NE(second, nullptr);
+	EXPECT_STREQ(first, second);
+
+	// The file's length, as probing its headers gives it.
+	AudioProbe probe;
+	ASSERT_EQ(ProbeAudioFile(tempPath.c_str(), &probe), SignatureSuccess);
+
+	double duration = SignatureSessionGetDuration(session);
+	EXPECT_GT(duration, 0.0);
+	EXPECT_DOUBLE_EQ(duration, probe.duration);
+
+	FreeAudioSignature(first);
+	FreeAudioSignature(second);
+	DestroySignatureSession(session);
+}
+
+TEST(TestRawAudioSignature, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	size_t length = 0;
+	int algorithm = -1;
+
+	int status = GetRawAudioSignature(
+		tempPath.c_str(), nullptr, 0, &length, &algorithm);
+
+	ASSERT_EQ(status, SignatureBufferTooSmall);
+	ASSERT_GT(length, 0u);
+
+	std::vector<uint32_t> buffer(length);
+
+	status = GetRawAudioSignature(
+		tempPath.c_str(), buffer.data(), buffer.size(), &length, &algorithm);
+
+	EXPECT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(length, buffer.size());
+	EXPECT_EQ(algorithm, 1);
+}
+
+TEST(TestAudioSignatureToBuffer, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	size_t length = 0;
+
+	int status = GetAudioSignatureToBuffer(
+		tempPath.c_str(), nullptr, nullptr, 0, &length);
+
+	ASSERT_EQ(status, SignatureBufferTooSmall);
+	ASSERT_GT(length, 0u);
+
+	std::vector<char> buffer(length + 1);
+
+	status = GetAudioSignatureToBuffer(
+		tempPath.c_str(), nullptr, buffer.data(), buffer.size(), &length);
+
+	EXPECT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(length, buffer.size() - 1);
+
+	char* result = GetAudioSignature(tempPath.c_str());
+
+	ASSERT_NE(result, nullptr);
+	EXPECT_STREQ(buffer.data(), result);
+
+	FreeAudioSignature(result);
+}
+
+TEST(TestAudioSignatureWithOptions, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+
+	char* fullResult = GetAudioSignatureWithOptions(tempPath.c_str(), &options);
+	char* result = GetAudioSignature(tempPath.c_str());
+
+	ASSERT_NE(fullResult, nullptr);
+	ASSERT_NE(result, nullptr);
+	EXPECT_STREQ(fullResult, result);
+
+	options.maxDuration = 30;
+
+	char* quickResult =
+		GetAudioSignatureWithOptions(tempPath.c_str(), &options);
+
+	ASSERT_NE(quickResult, nullptr);
+	EXPECT_LT(strlen(quickResult), strlen(fullResult));
+
+	options.algorithm = 99;
+
+	EXPECT_EQ(GetAudioSignatureWithOptions(tempPath.c_str(), &options), nullptr);
+
+	FreeAudioSignature(fullResult);
+	FreeAudioSignature(result);
+	FreeAudioSignature(quickResult);
+}
+
+TEST(TestAudioSignatureChunks, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+	options.maxDuration = 0;
+	options.maxChunkDuration = 10;
+
+	SignatureChunk* chunks = nullptr;
+	size_t count = 0;
+
+	int status =
+		GetAudioSignatureChunks(tempPath.c_str(), &options, &chunks, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	ASSERT_GT(count, 1u);
+
+	double timestamp = 0.0;
+
+	for (size_t index = 0; index < count; index++)
+	{
+		EXPECT_NE(chunks[index].audioSignature, nullptr);
+		EXPECT_DOUBLE_EQ(chunks[index].timestamp, timestamp);
+
+		timestamp += chunks[index].duration;
+	}
+
+	FreeAudioSignatureChunks(chunks, count);
+}
+
+TEST(TestSignatureStream, Success)
+{
+	const int sampleRate = 44100;
+	const int channels = 2;
+
+	std::vector<int16_t> samples(sampleRate * channels * 30);
+
+	for (size_t index = 0; index < samples.size(); index += channels)
+	{
+		double time = static_cast<double>(index / channels) / sampleRate;
+		double value = std::sin(time * 440.0 * 2.0 * 3.141592653589793) *
+			std::sin(time * 3.0);
+		int16_t sample = static_cast<int16_t>(value * 16000);
+
+		samples[index] = sample;
+		samples[index + 1] = sample;
+	}
+
+	SignatureStream* stream = SignatureStreamBegin(sampleRate, channels);
+
+	ASSERT_NE(stream, nullptr);
+
+	int status =
+		SignatureStreamFeed(stream, samples.data(), samples.size());
+
+	EXPECT_EQ(status, SignatureSuccess);
+
+	char* result = SignatureStreamFinish(stream);
+
+	EXPECT_NE(result, nullptr);
+
+	FreeAudioSignature(result);
+}
+
+TEST(TestAudioSignatureWithOptions, MemoryMapped)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+	options.inputMode = SignatureInputMemoryMapped;
+
+	char* mappedResult =
+		GetAudioSignatureWithOptions(tempPath.c_str(), &options);
+	char* result = GetAudioSignature(tempPath.c_str());
+
+	ASSERT_NE(mappedResult, nullptr);
+	ASSERT_NE(result, nullptr);
+	EXPECT_STREQ(mappedResult, result);
+
+	FreeAudioSignature(mappedResult);
+	FreeAudioSignature(result);
+}
+
+TEST(TestAudioSignatureWithOptions, DecoderThreads)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+	options.decoderThreads = 0;
+
+	char* threadedResult =
+		GetAudioSignatureWithOptions(tempPath.c_str(), &options);
+	char* result = GetAudioSignature(tempPath.c_str());
+
+	ASSERT_NE(threadedResult, nullptr);
+	ASSERT_NE(result, nullptr);
+	EXPECT_STREQ(threadedResult, result);
+
+	FreeAudioSignature(threadedResult);
+	FreeAudioSignature(result);
+}
+
+TEST(TestAudioSignatureWithOptions, Cancelled)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureCancellation* cancellation = CreateSignatureCancellation();
+
+	ASSERT_NE(cancellation, nullptr);
+
+	CancelSignature(cancellation);
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+	options.cancellation = cancellation;
+
+	SignatureSession* session = CreateSignatureSession();
+
+	ASSERT_NE(session, nullptr);
+	ASSERT_EQ(SignatureSessionSetOptions(session, &options), SignatureSuccess);
+
+	char* result = SignatureSessionRun(session, tempPath.c_str());
+
+	EXPECT_EQ(result, nullptr);
+	EXPECT_EQ(SignatureSessionGetStatus(session), SignatureCancelled);
+
+	DestroySignatureSession(session);
+	DestroySignatureCancellation(cancellation);
+}
+
+TEST(TestAudioSignatureWithOptions, ReadLimit)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+	options.maxBytesRead = 1024;
+
+	SignatureChunk* chunks = nullptr;
+	size_t count = 0;
+
+	int status =
+		GetAudioSignatureChunks(tempPath.c_str(), &options, &chunks, &count);
+
+	EXPECT_EQ(status, SignatureReadLimitExceeded);
+	EXPECT_EQ(chunks, nullptr);
+	EXPECT_EQ(count, 0u);
+}
+
+TEST(TestAudioSignatureWithOptions, FastResampling)
+{
+	char* appdata = std::getenv("APPDATA");
+
+	EXPECT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+
+	std::string tempPath = path.string();
+
+	SignatureOptions options;
+	GetDefaultSignatureOptions(&options);
+
+	SignatureSession* session = CreateSignatureSession();
+
+	ASSERT_NE(session, nullptr);
+
+	std::vector<uint32_t> compatible(4096);
+	std::vector<uint32_t> fast(4096);
+	size_t compatibleLength = 0;
+	size_t fastLength = 0;
+	int algorithm = 0;
+
+	int status = SignatureSessionRunRaw(
+		session,
+		tempPath.c_str(),
+		compatible.data(),
+		compatible.size(),
+		&compatibleLength,
+		&algorithm);
+
+	ASSERT_EQ(status, SignatureSuccess);
+
+	options.resampleMode = SignatureResampleFast;
+	status = SignatureSessionSetOptions(session, &options);
+
+	ASSERT_EQ(status, SignatureSuccess);
+
+	status = SignatureSessionRunRaw(
+		session,
+		tempPath.c_str(),
+		fast.data(),
+		fast.size(),
+		&fastLength,
+		&algorithm);
+
+	ASSERT_EQ(status, SignatureSuccess);
+
+	// The filters differ, so the fingerprints need only be close, and
+	// aligned.
+	double bitErrorRate = 1.0;
+	int bestOffset = 0;
+
+	status = CompareAudioSignatures(
+		compatible.data(),
+		compatibleLength,
+		fast.data(),
+		fastLength,
+		4,
+		&bitErrorRate,
+		&bestOffset);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(bestOffset, 0);
+	EXPECT_LT(bitErrorRate, 0.05);
+
+	DestroySignatureSession(session);
+}
+
+TEST(TestCompareAudioSignatures, Alignment)
+{
+	std::vector<uint32_t> first(1000);
+	uint32_t value = 12345;
+
+	for (uint32_t& item : first)
+	{
+		value = value * 1664525 + 1013904223;
+		item = value;
+	}
+
+	std::vector<uint32_t> second(first.begin() + 7, first.end());
+	second[10] ^= 0xff;
+
+	double bitErrorRate = 1.0;
+	int bestOffset = 0;
+
+	int status = CompareAudioSignatures(
+		first.data(),
+		first.size(),
+		second.data(),
+		second.size(),
+		20,
+		&bitErrorRate,
+		&bestOffset);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(bestOffset, 7);
+	EXPECT_DOUBLE_EQ(bitErrorRate, 8.0 / (second.size() * 32.0));
+
+	status = CompareAudioSignatures(
+		second.data(),
+		second.size(),
+		first.data(),
+		first.size(),
+		20,
+		&bitErrorRate,
+		&bestOffset);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(bestOffset, -7);
+
+	// The widest window is cut down to the fingerprints' lengths.
+	status = CompareAudioSignatures(
+		first.data(),
+		first.size(),
+		second.data(),
+		second.size(),
+		INT_MAX,
+		&bitErrorRate,
+		&bestOffset);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(bestOffset, 7);
+}
+
+TEST(TestFingerprintIndex, Search)
+{
+	FingerprintIndex* index = CreateFingerprintIndex(28);
+	ASSERT_NE(index, nullptr);
+
+	std::vector<std::vector<uint32_t>> tracks(20);
+	uint32_t value = 12345;
+
+	for (uint32_t trackId = 0; trackId < tracks.size(); trackId++)
+	{
+		tracks[trackId].resize(500);
+
+		for (uint32_t& item : tracks[trackId])
+		{
+			value = value * 1664525 + 1013904223;
+			item = value;
+		}
+
+		int status = FingerprintIndexAdd(
+			index,
+			trackId,
+			tracks[trackId].data(),
+			tracks[trackId].size());
+		ASSERT_EQ(status, SignatureSuccess);
+	}
+
+	// A later excerpt, with the low bits disturbed as by a re-encode.
+	std::vector<uint32_t> query(
+		tracks[5].begin() + 100, tracks[5].begin() + 300);
+
+	for (uint32_t& item : query)
+	{
+		item ^= 0x3;
+	}
+
+	FingerprintMatch matches[4];
+	size_t count = 0;
+
+	int status = FingerprintIndexSearch(
+		index, query.data(), query.size(), 10, matches, 4, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	ASSERT_EQ(count, 1u);
+	EXPECT_EQ(matches[0].trackId, 5u);
+	EXPECT_EQ(matches[0].matches, 200u);
+	EXPECT_EQ(matches[0].offset, 100);
+
+	DestroyFingerprintIndex(index);
+}
+
+TEST(TestFingerprintIndex, ReplaceAndRemove)
+{
+	FingerprintIndex* index = CreateFingerprintIndex(32);
+	ASSERT_NE(index, nullptr);
+
+	std::vector<uint32_t> first(300);
+	std::vector<uint32_t> second(300);
+	uint32_t value = 54321;
+
+	for (size_t item = 0; item < first.size(); item++)
+	{
+		value = value * 1664525 + 1013904223;
+		first[item] = value;
+		value = value * 1664525 + 1013904223;
+		second[item] = value;
+	}
+
+	// Two tracks with the same audio tie, and come in track id order,
+	// whichever was added first.
+	ASSERT_EQ(FingerprintIndexAdd(index, 7, first.data(), first.size()),
+		SignatureSuccess);
+	ASSERT_EQ(FingerprintIndexAdd(index, 3, first.data(), first.size()),
+		SignatureSuccess);
+
+	FingerprintMatch matches[4];
+	size_t count = 0;
+
+	int status = FingerprintIndexSearch(
+		index, first.data(), first.size(), 10, matches, 4, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	ASSERT_EQ(count, 2u);
+	EXPECT_EQ(matches[0].trackId, 3u);
+	EXPECT_EQ(matches[1].trackId, 7u);
+	EXPECT_EQ(matches[0].matches, 300u);
+	EXPECT_EQ(matches[1].matches, 300u);
+
+	// Adding a track again replaces it, rather than doubling its votes.
+	ASSERT_EQ(FingerprintIndexAdd(index, 3, first.data(), first.size()),
+		SignatureSuccess);
+	ASSERT_EQ(FingerprintIndexAdd(index, 7, second.data(), second.size()),
+		SignatureSuccess);
+
+	status = FingerprintIndexSearch(
+		index, first.data(), first.size(), 10, matches, 4, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	ASSERT_EQ(count, 1u);
+	EXPECT_EQ(matches[0].trackId, 3u);
+	EXPECT_EQ(matches[0].matches, 300u);
+
+	status = FingerprintIndexSearch(
+		index, second.data(), second.size(), 10, matches, 4, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	ASSERT_EQ(count, 1u);
+	EXPECT_EQ(matches[0].trackId, 7u);
+
+	EXPECT_EQ(FingerprintIndexRemove(index, 3), SignatureSuccess);
+	EXPECT_EQ(FingerprintIndexRemove(index, 3), SignatureFailed);
+
+	status = FingerprintIndexSearch(
+		index, first.data(), first.size(), 10, matches, 4, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(count, 0u);
+
+	DestroyFingerprintIndex(index);
+}
+
+TEST(TestSignatureCache, Reopen)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	std::filesystem::path cachePath =
+		std::filesystem::temp_directory_path() / "AudioSignature.cache";
+	std::string cacheFile = cachePath.string();
+	std::filesystem::remove(cachePath);
+
+	// Only decoded files are counted, so the stats show whether a call
+	// was served from the cache.
+	auto getFilesDecoded = []()
+	{
+		SignatureStats stats[8];
+		size_t count = 0;
+		uint64_t files = 0;
+
+		GetAudioSignatureStats(stats, 8, &count);
+
+		for (size_t index = 0; index < count && index < 8; index++)
+		{
+			files += stats[index].files;
+		}
+
+		return files;
+	};
+
+	char* expected = GetAudioSignature(dataPath.c_str());
+	ASSERT_NE(expected, nullptr);
+
+	ASSERT_EQ(OpenSignatureCache(cacheFile.c_str()), SignatureSuccess);
+
+	char* first = GetAudioSignature(dataPath.c_str());
+	ASSERT_EQ(CloseSignatureCache(), SignatureSuccess);
+	EXPECT_TRUE(std::filesystem::exists(cachePath));
+
+	uintmax_t cacheSize = std::filesystem::file_size(cachePath);
+
+	ASSERT_EQ(OpenSignatureCache(cacheFile.c_str()), SignatureSuccess);
+
+	ResetAudioSignatureStats();
+	char* second = GetAudioSignature(dataPath.c_str());
+	EXPECT_EQ(getFilesDecoded(), 0u);
+
+	// A copy that then changes is decoded again.
+	std::filesystem::path copyPath =
+		std::filesystem::temp_directory_path() / "AudioSignatureCopy.mp4";
+	std::string copyFile = copyPath.string();
+	std::filesystem::copy_file(
+		path, copyPath, std::filesystem::copy_options::overwrite_existing);
+
+	char* copy = GetAudioSignature(copyFile.c_str());
+	EXPECT_EQ(getFilesDecoded(), 1u);
+	FreeAudioSignature(copy);
+
+	copy = GetAudioSignature(copyFile.c_str());
+	EXPECT_EQ(getFilesDecoded(), 1u);
+	FreeAudioSignature(copy);
+
+	std::filesystem::last_write_time(
+		copyPath,
+		std::filesystem::last_write_time(copyPath) + std::chrono::hours(1));
+
+	copy = GetAudioSignature(copyFile.c_str());
+	EXPECT_EQ(getFilesDecoded(), 2u);
+	ASSERT_NE(copy, nullptr);
+	EXPECT_STREQ(copy, expected);
+	FreeAudioSignature(copy);
+
+	// Records are kept for files that cannot be reached, as on a drive
+	// not mounted when the cache is saved.
+	std::filesystem::remove(copyPath);
+	ASSERT_EQ(CloseSignatureCache(), SignatureSuccess);
+	EXPECT_GT(std::filesystem::file_size(cachePath), cacheSize);
+
+	ASSERT_NE(first, nullptr);
+	ASSERT_NE(second, nullptr);
+	EXPECT_STREQ(first, expected);
+	EXPECT_STREQ(second, expected);
+
+	FreeAudioSignature(expected);
+	FreeAudioSignature(first);
+	FreeAudioSignature(second);
+	std::filesystem::remove(cachePath);
+}
+
+TEST(TestAudioContentHash, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	char* nativeHash = GetAudioContentHash(dataPath.c_str(), false);
+	char* normalizedHash = GetAudioContentHash(dataPath.c_str(), true);
+	char* repeatedHash = GetAudioContentHash(dataPath.c_str(), true);
+
+	ASSERT_NE(nativeHash, nullptr);
+	ASSERT_NE(normalizedHash, nullptr);
+	ASSERT_NE(repeatedHash, nullptr);
+
+	EXPECT_EQ(strlen(nativeHash), 64u);
+	EXPECT_STREQ(normalizedHash, repeatedHash);
+
+	// The 48 kHz file resampled as ffmpeg -i sakura.mp4 -f s16le
+	// -acodec pcm_s16le -ar 44100 -ac 2 - | sha256sum does.
+	EXPECT_STREQ(
+		normalizedHash,
+		"d3035c13df0828436044099fe8d4e64d9bc0419bbea7f903c96dd88b076577dc");
+
+	FreeAudioSignature(nativeHash);
+	FreeAudioSignature(normalizedHash);
+	FreeAudioSignature(repeatedHash);
+}
+
+TEST(TestCompareAudioContent, SameFile)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	AudioContentComparison comparison;
+
+	int status = CompareAudioContent(
+		dataPath.c_str(), dataPath.c_str(), &comparison);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(comparison.identical, 1);
+	EXPECT_EQ(comparison.mismatchOffset, -1);
+	EXPECT_EQ(comparison.formatDifferences, AudioFormatSame);
+}
+
+// Writes interleaved 16 bit samples as a PCM WAV file.
+static void WriteWaveFile(
+	const std::filesystem::path& filePath,
+	uint32_t sampleRate,
+	uint16_t channels,
+	const std::vector<int16_t>& samples)
+{
+	uint32_t dataSize =
+		static_cast<uint32_t>(samples.size() * sizeof(int16_t));
+	uint32_t riffSize = 36 + dataSize;
+	uint32_t formatSize = 16;
+	uint16_t formatTag = 1;
+	uint16_t blockAlign = channels * sizeof(int16_t);
+	uint32_t byteRate = sampleRate * blockAlign;
+	uint16_t bitsPerSample = 16;
+
+	std::ofstream file(filePath, std::ios::binary);
+
+	file.write("RIFF", 4);
+	file.write(reinterpret_cast<const char*>(&riffSize), 4);
+	file.write("WAVEfmt ", 8);
+	file.write(reinterpret_cast<const char*>(&formatSize), 4);
+	file.write(reinterpret_cast<const char*>(&formatTag), 2);
+	file.write(reinterpret_cast<const char*>(&channels), 2);
+	file.write(reinterpret_cast<const char*>(&sampleRate), 4);
+	file.write(reinterpret_cast<const char*>(&byteRate), 4);
+	file.write(reinterpret_cast<const char*>(&blockAlign), 2);
+	file.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
+	file.write("data", 4);
+	file.write(reinterpret_cast<const char*>(&dataSize), 4);
+	file.write(reinterpret_cast<const char*>(samples.data()), dataSize);
+}
+
+TEST(TestCompareAudioContent, Mismatch)
+{
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "AudioSignatureCompare";
+	std::filesystem::create_directories(directory);
+
+	// Long enough to span several of the blocks compared at once.
+	const size_t frames = 20000;
+	std::vector<int16_t> samples(frames * 2);
+
+	for (size_t index = 0; index < samples.size(); index++)
+	{
+		samples[index] = static_cast<int16_t>((index * 37) % 20000);
+	}
+
+	std::vector<int16_t> changed = samples;
+	changed[10000 * 2 + 1] ^= 1;
+
+	std::vector<int16_t> trimmed(samples.begin(), samples.begin() + 800 * 2);
+
+	std::string originalPath = (directory / "original.wav").string();
+	std::string changedPath = (directory / "changed.wav").string();
+	std::string trimmedPath = (directory / "trimmed.wav").string();
+	std::string resampledPath = (directory / "resampled.wav").string();
+
+	WriteWaveFile(originalPath, 44100, 2, samples);
+	WriteWaveFile(changedPath, 44100, 2, changed);
+	WriteWaveFile(trimmedPath, 44100, 2, trimmed);
+	WriteWaveFile(resampledPath, 48000, 2, samples);
+
+	AudioContentComparison comparison;
+
+	// One sample of one channel differs, far into the file.
+	int status = CompareAudioContent(
+		originalPath.c_str(), changedPath.c_str(), &comparison);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(comparison.identical, 0);
+	EXPECT_EQ(comparison.mismatchOffset, 10000);
+	EXPECT_EQ(comparison.formatDifferences, AudioFormatSame);
+
+	// The shorter is the start of the longer, either way round.
+	status = CompareAudioContent(
+		originalPath.c_str(), trimmedPath.c_str(), &comparison);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(comparison.identical, 0);
+	EXPECT_EQ(comparison.mismatchOffset, 800);
+
+	status = CompareAudioContent(
+		trimmedPath.c_str(), originalPath.c_str(), &comparison);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(comparison.identical, 0);
+	EXPECT_EQ(comparison.mismatchOffset, 800);
+
+	// The same samples at another rate differ from the start, without
+	// any decoding.
+	status = CompareAudioContent(
+		originalPath.c_str(), resampledPath.c_str(), &comparison);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(comparison.identical, 0);
+	EXPECT_EQ(comparison.mismatchOffset, 0);
+	EXPECT_EQ(comparison.formatDifferences, AudioFormatSampleRate);
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TestAudioSignatureStats, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	ResetAudioSignatureStats();
+
+	char* result = GetAudioSignature(dataPath.c_str());
+	ASSERT_NE(result, nullptr);
+	FreeAudioSignature(result);
+
+	size_t count = 0;
+	int status = GetAudioSignatureStats(nullptr, 0, &count);
+
+	ASSERT_EQ(status, SignatureBufferTooSmall);
+	ASSERT_EQ(count, 1u);
+
+	SignatureStats stats;
+	status = GetAudioSignatureStats(&stats, 1, &count);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_STREQ(stats.codec, "aac");
+	EXPECT_EQ(stats.files, 1u);
+	EXPECT_GT(stats.audioSeconds, 0.0);
+	EXPECT_GT(stats.openSeconds, 0.0);
+	EXPECT_GT(stats.decodeSeconds, 0.0);
+	EXPECT_GT(stats.fingerprintSeconds, 0.0);
+}
+
+TEST(TestAnalyzeAudioFile, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	AudioAnalysis analysis;
+
+	int status = AnalyzeAudioFile(
+		dataPath.c_str(), nullptr, AudioAnalysisAll, &analysis);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(analysis.completed, AudioAnalysisAll);
+
+	// Each part matches what its own call gives.
+	char* signature = GetAudioSignature(dataPath.c_str());
+	char* contentHash = GetAudioContentHash(dataPath.c_str(), false);
+
+	ASSERT_NE(signature, nullptr);
+	ASSERT_NE(contentHash, nullptr);
+	ASSERT_NE(analysis.audioSignature, nullptr);
+	EXPECT_STREQ(analysis.audioSignature, signature);
+	EXPECT_STREQ(analysis.contentHash, contentHash);
+
+	EXPECT_STREQ(analysis.codec, "aac");
+	EXPECT_GT(analysis.sampleRate, 0);
+	EXPECT_GT(analysis.channels, 0);
+	EXPECT_GT(analysis.duration, 0.0);
+	EXPECT_TRUE(std::isfinite(analysis.integratedLoudness));
+	EXPECT_LT(analysis.integratedLoudness, 0.0);
+	EXPECT_GT(analysis.samplePeak, 0.0);
+
+	FreeAudioSignature(signature);
+	FreeAudioSignature(contentHash);
+	FreeAudioAnalysis(&analysis);
+}
+
+TEST(TestProbeAudioFile, Success)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	AudioProbe probe;
+
+	int status = ProbeAudioFile(dataPath.c_str(), &probe);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_STREQ(probe.codec, "aac");
+	EXPECT_EQ(probe.lossless, 0);
+	EXPECT_GT(probe.sampleRate, 0);
+	EXPECT_GT(probe.channels, 0);
+	EXPECT_GT(probe.bitRate, 0);
+
+	// The headers' length agrees with the audio actually decoded.
+	AudioAnalysis analysis;
+
+	status = AnalyzeAudioFile(
+		dataPath.c_str(), nullptr, AudioAnalysisProperties, &analysis);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_NEAR(probe.duration, analysis.duration, 0.5);
+	EXPECT_EQ(probe.sampleRate, analysis.sampleRate);
+	EXPECT_EQ(probe.channels, analysis.channels);
+
+	FreeAudioAnalysis(&analysis);
+
+	status = ProbeAudioFile("missing.mp4", &probe);
+
+	EXPECT_EQ(status, SignatureFailed);
+}
+
+// Remuxes the audio of a file, adding title and artist tags and a cover
+// picture, for the tests on what a transcode keeps.
+static bool WriteTaggedCopy(
+	const std::string& sourcePath, const std::string& copyPath)
+{
+	// A 1 by 1 grey PNG.
+	static const uint8_t picture[] =
+	{
+		0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00,
+		0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+		0x00, 0x01, 0x08, 0x00, 0x00, 0x00, 0x00, 0x3a, 0x7e, 0x9b, 0x55,
+		0x00, 0x00, 0x00, 0x0a, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63,
+		0x60, 0x00, 0x00, 0x00, 0x02, 0x00, 0x01, 0xe5, 0x27, 0xde, 0xfc,
+		0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60,
+		0x82
+	};
+
+	AVFormatContext* input = nullptr;
+	AVFormatContext* output = nullptr;
+	AVStream* audio = nullptr;
+	AVStream* cover = nullptr;
+	AVPacket* packet = av_packet_alloc();
+
+	bool written = packet != nullptr &&
+		avformat_open_input(
+			&input, sourcePath.c_str(), nullptr, nullptr) == 0 &&
+		avformat_find_stream_info(input, nullptr) >= 0 &&
+		avformat_alloc_output_context2(
+			&output, nullptr, nullptr, copyPath.c_str()) >= 0;
+
+	int audioIndex = written ? av_find_best_stream(
+		input, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0) : -1;
+
+	if (audioIndex >= 0)
+	{
+		audio = avformat_new_stream(output, nullptr);
+		cover = avformat_new_stream(output, nullptr);
+	}
+
+	written = audio != nullptr && cover != nullptr &&
+		avcodec_parameters_copy(
+			audio->codecpar, input->streams[audioIndex]->codecpar) >= 0;
+
+	if (written == true)
+	{
+		audio->codecpar->codec_tag = 0;
+		audio->time_base = input->streams[audioIndex]->time_base;
+
+		cover->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+		cover->codecpar->codec_id = AV_CODEC_ID_PNG;
+		cover->codecpar->width = 1;
+		cover->codecpar->height = 1;
+		cover->disposition = AV_DISPOSITION_ATTACHED_PIC;
+
+		av_dict_set(&output->metadata, "title", "Sakura", 0);
+		av_dict_set(&output->metadata, "artist", "AudioSignature", 0);
+
+		written = avio_open(
+			&output->pb, copyPath.c_str(), AVIO_FLAG_WRITE) >= 0 &&
+			avformat_write_header(output, nullptr) >= 0 &&
+			av_new_packet(packet, sizeof(picture)) >= 0;
+	}
+
+	if (written == true)
+	{
+		std::memcpy(packet->data, picture, sizeof(picture));
+		packet->stream_index = cover->index;
+		packet->flags |= AV_PKT_FLAG_KEY;
+		packet->pts = 0;
+		packet->dts = 0;
+
+		written = av_interleaved_write_frame(output, packet) >= 0;
+	}
+
+	while (written == true && av_read_frame(input, packet) >= 0)
+	{
+		if (packet->stream_index == audioIndex)
+		{
+			av_packet_rescale_ts(packet,
+				input->streams[audioIndex]->time_base, audio->time_base);
+			packet->stream_index = audio->index;
+			packet->pos = -1;
+
+			written = av_interleaved_write_frame(output, packet) >= 0;
+		}
+
+		av_packet_unref(packet);
+	}
+
+	written = written == true && av_write_trailer(output) == 0;
+
+	if (output != nullptr)
+	{
+		avio_closep(&output->pb);
+		avformat_free_context(output);
+	}
+
+	avformat_close_input(&input);
+	av_packet_free(&packet);
+
+	return written;
+}
+
+// Checks that a transcode kept the tags and the cover picture written by
+// WriteTaggedCopy.
+static void ExpectTagsAndCoverArt(const std::string& filePath)
+{
+	AVFormatContext* input = nullptr;
+
+	int result =
+		avformat_open_input(&input, filePath.c_str(), nullptr, nullptr);
+	ASSERT_EQ(result, 0);
+
+	const AVDictionaryEntry* title =
+		av_dict_get(input->metadata, "title", nullptr, 0);
+	const AVDictionaryEntry* artist =
+		av_dict_get(input->metadata, "artist", nullptr, 0);
+
+	ASSERT_NE(title, nullptr);
+	ASSERT_NE(artist, nullptr);
+	EXPECT_STREQ(title->value, "Sakura");
+	EXPECT_STREQ(artist->value, "AudioSignature");
+
+	bool hasCoverArt = false;
+
+	for (unsigned int index = 0; index < input->nb_streams; index++)
+	{
+		const AVStream* stream = input->streams[index];
+
+		if ((stream->disposition & AV_DISPOSITION_ATTACHED_PIC) &&
+			stream->attached_pic.size > 0)
+		{
+			hasCoverArt = true;
+		}
+	}
+
+	EXPECT_TRUE(hasCoverArt);
+
+	avformat_close_input(&input);
+}
+
+TEST(TestTranscodeAudioFiles, LosslessRoundTrip)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "AudioSignatureTranscode";
+	std::filesystem::create_directories(directory);
+
+	// The tags and the cover art are carried through both transcodes.
+	std::string taggedPath = (directory / "tagged.m4a").string();
+	ASSERT_TRUE(WriteTaggedCopy(dataPath, taggedPath));
+
+	std::string flacPath = (directory / "sakura.flac").string();
+	std::string alacPath = (directory / "sakura.m4a").string();
+	std::string missingPath = (directory / "missing.flac").string();
+
+	TranscodeOptions options;
+	GetDefaultTranscodeOptions(&options);
+	options.overwrite = 1;
+
+	const char* inputPaths[] = { taggedPath.c_str(), "missing.mp4" };
+	const char* outputPaths[] = { flacPath.c_str(), missingPath.c_str() };
+	int statuses[2] = { -1, -1 };
+
+	int count =
+		TranscodeAudioFiles(inputPaths, outputPaths, 2, &options, statuses);
+
+	ASSERT_EQ(count, 1);
+	EXPECT_EQ(statuses[0], SignatureSuccess);
+	EXPECT_EQ(statuses[1], SignatureFailed);
+	EXPECT_FALSE(std::filesystem::exists(missingPath));
+
+	AudioProbe probe;
+
+	ASSERT_EQ(ProbeAudioFile(flacPath.c_str(), &probe), SignatureSuccess);
+	EXPECT_STREQ(probe.codec, "flac");
+	EXPECT_EQ(probe.lossless, 1);
+	ExpectTagsAndCoverArt(flacPath);
+
+	// FLAC to ALAC, as the conversion scripts do, keeps every sample.
+	options.encoder = "alac";
+
+	const char* flacPaths[] = { flacPath.c_str() };
+	const char* alacPaths[] = { alacPath.c_str() };
+
+	count = TranscodeAudioFiles(flacPaths, alacPaths, 1, &options, statuses);
+
+	ASSERT_EQ(count, 1);
+	ExpectTagsAndCoverArt(alacPath);
+
+	AudioContentComparison comparison;
+
+	int status = CompareAudioContent(
+		flacPath.c_str(), alacPath.c_str(), &comparison);
+
+	ASSERT_EQ(status, SignatureSuccess);
+	EXPECT_EQ(comparison.identical, 1);
+
+	// Without overwrite, an existing output is left alone.
+	options.overwrite = 0;
+
+	count = TranscodeAudioFiles(flacPaths, alacPaths, 1, &options, statuses);
+
+	EXPECT_EQ(count, 0);
+	EXPECT_EQ(statuses[0], SignatureFailed);
+
+	std::filesystem::remove_all(directory);
+}
+
+TEST(TestTranscodeAudioFiles, DuplicateOutputs)
+{
+	char* appdata = std::getenv("APPDATA");
+	ASSERT_NE(appdata, nullptr);
+
+	std::filesystem::path path = appdata;
+	path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+	std::string dataPath = path.string();
+
+	std::filesystem::path directory =
+		std::filesystem::temp_directory_path() / "AudioSignatureDuplicate";
+	std::filesystem::create_directories(directory);
+
+	// The same output, once spelled through a parent directory.
+	std::string outputPath = (directory / "sakura.flac").string();
+	std::string otherPath =
+		(directory / ".." / directory.filename() / "sakura.flac").string();
+	std::string uniquePath = (directory / "unique.flac").string();
+
+	TranscodeOptions options;
+	GetDefaultTranscodeOptions(&options);
+
+	const char* inputPaths[] =
+		{ dataPath.c_str(), dataPath.c_str(), dataPath.c_str() };
+	const char* outputPaths[] =
+		{ outputPath.c_str(), otherPath.c_str(), uniquePath.c_str() };
+	int statuses[3] = { -1, -1, -1 };
+
+	int count =
+		TranscodeAudioFiles(inputPaths, outputPaths, 3, &options, statuses);
+
+	EXPECT_EQ(count, 1);
+	EXPECT_EQ(statuses[0], SignatureInvalidArgument);
+	EXPECT_EQ(statuses[1], SignatureInvalidArgument);
+	EXPECT_EQ(statuses[2], SignatureSuccess);
+	EXPECT_FALSE(std::filesystem::exists(outputPath));
+	EXPECT_TRUE(std::filesystem::exists(uniquePath));
+
+	std::filesystem::remove_all(directory);
+}
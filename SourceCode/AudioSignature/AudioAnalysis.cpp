@@ -0,0 +1,647 @@
+﻿#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#pragma warning( push )
+#include "../ChromaPrint/src/chromaprint.h"
+#pragma warning(pop)
+
+#include "AudioAnalysis.h"
+#include "FastResampler.h"
+#include "LoudnessMeter.h"
+#include "Sha256.h"
+#include "SignatureInternal.h"
+
+namespace AudioSignature
+{
+	// One of the analyses asked for, with the flag it sets on completing.
+	struct AnalysisPart
+	{
+		int type = 0;
+		bool active = true;
+		std::unique_ptr<AudioConsumer> consumer;
+	};
+
+	std::vector<AnalysisPart> MakeAnalysisParts(
+		int analyses, const SignatureOptions& options);
+	void ToFloat(
+		const uint8_t* data,
+		AVSampleFormat format,
+		size_t count,
+		std::vector<float>& output);
+
+	// Hashes the decoded bytes, as GetAudioContentHash does.
+	class ContentHashConsumer : public AudioConsumer
+	{
+	public:
+		bool Begin(const AudioReader& reader) override
+		{
+			frameSize = static_cast<size_t>(reader.GetChannels()) *
+				av_get_bytes_per_sample(reader.GetSampleFormat());
+
+			return frameSize > 0;
+		}
+
+		bool Consume(const uint8_t* data, size_t frames) override
+		{
+			hash.Update(data, frames * frameSize);
+
+			return true;
+		}
+
+		bool Finish(AudioAnalysis& analysis) override
+		{
+			std::string digest = hash.Finish();
+
+			size_t size =
+				std::min(digest.size(), sizeof(analysis.contentHash) - 1);
+			std::copy(digest.begin(), digest.begin() + size,
+				analysis.contentHash);
+			analysis.contentHash[size] = 0;
+
+			return true;
+		}
+
+	private:
+		Sha256 hash;
+		size_t frameSize = 0;
+	};
+
+	// Meters the loudness and peak, as EBU R128 defines them.
+	class LoudnessConsumer : public AudioConsumer
+	{
+	public:
+		bool Begin(const AudioReader& reader) override
+		{
+			format = reader.GetSampleFormat();
+			channels = reader.GetChannels();
+
+			AVChannelLayout layout{};
+			reader.GetChannelLayout(&layout);
+
+			std::vector<double> weights(channels, 1.0);
+
+			for (int index = 0; index < channels; index++)
+			{
+				AVChannel channel =
+					av_channel_layout_channel_from_index(&layout, index);
+
+				switch (channel)
+				{
+					case AV_CHAN_LOW_FREQUENCY:
+					case AV_CHAN_LOW_FREQUENCY_2:
+						weights[index] = 0.0;
+						break;
+					case AV_CHAN_SIDE_LEFT:
+					case AV_CHAN_SIDE_RIGHT:
+					case AV_CHAN_BACK_LEFT:
+					case AV_CHAN_BACK_RIGHT:
+						weights[index] = 1.41;
+						break;
+					default:
+						break;
+				}
+			}
+
+			av_channel_layout_uninit(&layout);
+
+			bool begun = meter.Open(reader.GetSampleRate(), weights);
+
+			return begun;
+		}
+
+		bool Consume(const uint8_t* data, size_t frames) override
+		{
+			ToFloat(data, format, frames * channels, samples);
+			meter.Add(samples.data(), frames);
+
+			return true;
+		}
+
+		bool Finish(AudioAnalysis& analysis) override
+		{
+			analysis.integratedLoudness = meter.GetIntegratedLoudness();
+			analysis.samplePeak = meter.GetSamplePeak();
+
+			return true;
+		}
+
+	private:
+		LoudnessMeter meter;
+		std::vector<float> samples;
+		AVSampleFormat format = AV_SAMPLE_FMT_NONE;
+		int channels = 0;
+	};
+
+	// Records the format, and counts the audio decoded for the duration.
+	class PropertiesConsumer : public AudioConsumer
+	{
+	public:
+		bool Begin(const AudioReader& reader) override
+		{
+			codec = reader.GetCodecName();
+			sampleRate = reader.GetSampleRate();
+			channels = reader.GetChannels();
+			bitsPerSample = reader.GetBitsPerSample();
+			bitRate = reader.GetBitRate();
+
+			return sampleRate > 0;
+		}
+
+		bool Consume(const uint8_t*, size_t frames) override
+		{
+			frameCount += frames;
+
+			return true;
+		}
+
+		bool Finish(AudioAnalysis& analysis) override
+		{
+			size_t size = std::min(codec.size(), sizeof(analysis.codec) - 1);
+			std::copy(codec.begin(), codec.begin() + size, analysis.codec);
+			analysis.codec[size] = 0;
+
+			analysis.sampleRate = sampleRate;
+			analysis.channels = channels;
+			analysis.bitsPerSample = bitsPerSample;
+			analysis.bitRate = bitRate;
+			analysis.duration =
+				static_cast<double>(frameCount) / sampleRate;
+
+			return true;
+		}
+
+	private:
+		std::string codec;
+		int64_t bitRate = 0;
+		uint64_t frameCount = 0;
+		int sampleRate = 0;
+		int channels = 0;
+		int bitsPerSample = 0;
+	};
+
+	// Converts the audio to what chromaprint takes, as the reader does for
+	// the signature calls, and fingerprints the same stretch of it, so
+	// that the signature is the same as theirs.
+	class SignatureConsumer : public AudioConsumer
+	{
+	public:
+		explicit SignatureConsumer(const SignatureOptions& options)
+			: options(options), context(chromaprint_new(options.algorithm))
+		{
+		}
+
+		~SignatureConsumer() override
+		{
+			swr_free(&converter);
+			chromaprint_free(context);
+		}
+
+		SignatureConsumer(const SignatureConsumer&) = delete;
+		SignatureConsumer& operator=(const SignatureConsumer&) = delete;
+
+		bool Begin(const AudioReader& reader) override
+		{
+			bool begun = false;
+
+			AVSampleFormat format = reader.GetSampleFormat();
+			int channels = reader.GetChannels();
+			int sampleRate = reader.GetSampleRate();
+
+			outputChannels = chromaprint_get_num_channels(context);
+			outputRate = chromaprint_get_sample_rate(context);
+
+			usingFastResampler =
+				options.resampleMode == SignatureResampleFast &&
+				FastResampler::IsSupported(format,
+					channels,
+					sampleRate,
+					outputChannels,
+					outputRate);
+
+			if (usingFastResampler == true)
+			{
+				begun = fastResampler.Open(
+					format, channels, sampleRate, outputRate);
+			}
+			else
+			{
+				begun = OpenConverter(reader);
+			}
+
+			if (begun == true)
+			{
+				begun =
+					chromaprint_start(context, outputRate, outputChannels) != 0;
+			}
+
+			skipLimit =
+				static_cast<size_t>(options.startOffset * outputRate);
+			streamLimit =
+				static_cast<size_t>(options.maxDuration) * outputRate;
+
+			return begun;
+		}
+
+		bool Consume(const uint8_t* data, size_t frames) override
+		{
+			bool consumed = true;
+
+			if (done == false)
+			{
+				consumed = Convert(&data, frames);
+			}
+
+			return consumed;
+		}
+
+		bool Finish(AudioAnalysis& analysis) override
+		{
+			bool finished = true;
+
+			// Only audio that ran out before the limit has a tail still
+			// held by the converter, as with the reader.
+			if (done == false)
+			{
+				finished = Convert(nullptr, 0);
+			}
+
+			int size = 0;
+
+			if (finished == true)
+			{
+				finished = chromaprint_finish(context) != 0 &&
+					chromaprint_get_raw_fingerprint_size(context, &size) != 0 &&
+					size > 0;
+			}
+
+			if (finished == true)
+			{
+				finished = chromaprint_get_fingerprint(
+					context, &analysis.audioSignature) != 0;
+			}
+
+			return finished;
+		}
+
+		bool IsDone() const override
+		{
+			return done;
+		}
+
+	private:
+		bool Convert(const uint8_t** input, size_t frames)
+		{
+			int inputSize = static_cast<int>(frames);
+			size_t size = 0;
+
+			if (usingFastResampler == true)
+			{
+				const uint8_t* const* fastInput = input;
+				size = fastResampler.Convert(fastInput, inputSize, buffer);
+			}
+			else
+			{
+				int outputSize = swr_get_out_samples(converter, inputSize);
+
+				if (outputSize < 0)
+				{
+					return false;
+				}
+
+				size_t needed = static_cast<size_t>(outputSize) *
+					outputChannels * sizeof(int16_t);
+
+				if (buffer.size() < needed)
+				{
+					buffer.resize(needed);
+				}
+
+				uint8_t* output = buffer.data();
+
+				int result = swr_convert(
+					converter, &output, outputSize, input, inputSize);
+
+				if (result < 0)
+				{
+					return false;
+				}
+
+				size = static_cast<size_t>(result);
+			}
+
+			const int16_t* samples =
+				reinterpret_cast<const int16_t*>(buffer.data());
+
+			return Feed(samples, size);
+		}
+
+		bool Feed(const int16_t* samples, size_t size)
+		{
+			if (skipSize < skipLimit)
+			{
+				size_t skipped = std::min(size, skipLimit - skipSize);
+
+				skipSize += skipped;
+				samples += skipped * outputChannels;
+				size -= skipped;
+			}
+
+			if (streamLimit > 0)
+			{
+				size_t remaining = streamLimit - streamSize;
+
+				if (size > remaining)
+				{
+					size = remaining;
+					done = true;
+				}
+			}
+
+			streamSize += size;
+
+			bool fed = size == 0 ||
+				chromaprint_feed(
+					context, samples, static_cast<int>(size * outputChannels))
+				!= 0;
+
+			return fed;
+		}
+
+		bool OpenConverter(const AudioReader& reader)
+		{
+			AVChannelLayout inputLayout{};
+			AVChannelLayout outputLayout;
+
+			reader.GetChannelLayout(&inputLayout);
+			av_channel_layout_default(&outputLayout, outputChannels);
+
+			int result = swr_alloc_set_opts2(
+				&converter,
+				&outputLayout,
+				AV_SAMPLE_FMT_S16,
+				outputRate,
+				&inputLayout,
+				reader.GetSampleFormat(),
+				reader.GetSampleRate(),
+				0,
+				nullptr);
+
+			av_channel_layout_uninit(&inputLayout);
+			av_channel_layout_uninit(&outputLayout);
+
+			if (result >= 0)
+			{
+				SetCompatibleResampling(converter);
+
+				result = swr_init(converter);
+			}
+
+			return result >= 0;
+		}
+
+		SignatureOptions options;
+		ChromaprintContext* context;
+		SwrContext* converter = nullptr;
+		FastResampler fastResampler;
+		std::vector<uint8_t> buffer;
+
+		int outputChannels = 0;
+		int outputRate = 0;
+		size_t skipLimit = 0;
+		size_t skipSize = 0;
+		size_t streamLimit = 0;
+		size_t streamSize = 0;
+		bool done = false;
+		bool usingFastResampler = false;
+	};
+
+	int AnalyzeAudioFile(
+		const char* filePath,
+		const SignatureOptions* options,
+		int analyses,
+		AudioAnalysis* analysis)
+	{
+		int status = SignatureInvalidArgument;
+
+		SignatureOptions analysisOptions;
+		GetDefaultSignatureOptions(&analysisOptions);
+
+		if (options != nullptr)
+		{
+			analysisOptions = *options;
+		}
+
+		if (filePath != nullptr && analysis != nullptr &&
+			(analyses & ~AudioAnalysisAll) == 0 &&
+			IsValidOptions(&analysisOptions))
+		{
+			status = SignatureFailed;
+
+			*analysis = AudioAnalysis();
+			analysis->integratedLoudness =
+				-std::numeric_limits<double>::infinity();
+
+			std::vector<AnalysisPart> parts =
+				MakeAnalysisParts(analyses, analysisOptions);
+
+			// The samples are left as the decoder makes them, only
+			// packed, so that the hash matches GetAudioContentHash, and
+			// each consumer converts as it needs.
+			AudioReader reader;
+			reader.SetOutputSampleFormat(AV_SAMPLE_FMT_NONE);
+			reader.SetMemoryMapped(
+				analysisOptions.inputMode == SignatureInputMemoryMapped);
+			reader.SetDecoderThreads(analysisOptions.decoderThreads);
+			reader.SetBudget(MakeReadBudget(analysisOptions));
+
+			if (!reader.Open(filePath))
+			{
+				GetLogger()->error("ERROR: {}", reader.GetError());
+			}
+			else
+			{
+				for (AnalysisPart& part : parts)
+				{
+					part.active = part.consumer->Begin(reader);
+				}
+
+				size_t frameSize = static_cast<size_t>(reader.GetChannels()) *
+					av_get_bytes_per_sample(reader.GetSampleFormat());
+
+				const uint8_t* data = nullptr;
+				size_t size = 0;
+				bool allDone = false;
+
+				while (allDone == false && reader.ReadBytes(&data, &size))
+				{
+					size_t frames = size / frameSize;
+					allDone = true;
+
+					for (AnalysisPart& part : parts)
+					{
+						if (part.active == true)
+						{
+							part.active =
+								part.consumer->Consume(data, frames);
+
+							allDone = allDone && part.consumer->IsDone();
+						}
+					}
+				}
+
+				if (reader.GetInterruption() != ReadInterruption::None)
+				{
+					status = GetInterruptionStatus(reader.GetInterruption());
+				}
+				else if (allDone == false && !reader.IsFinished())
+				{
+					GetLogger()->error("ERROR: {}", reader.GetError());
+				}
+				else
+				{
+					for (AnalysisPart& part : parts)
+					{
+						if (part.active == true &&
+							part.consumer->Finish(*analysis))
+						{
+							analysis->completed |= part.type;
+						}
+					}
+
+					status = SignatureSuccess;
+				}
+			}
+		}
+
+		return status;
+	}
+
+	void FreeAudioAnalysis(AudioAnalysis* analysis)
+	{
+		if (analysis != nullptr)
+		{
+			FreeAudioSignature(analysis->audioSignature);
+			analysis->audioSignature = nullptr;
+		}
+	}
+
+	std::vector<AnalysisPart> MakeAnalysisParts(
+		int analyses, const SignatureOptions& options)
+	{
+		std::vector<AnalysisPart> parts;
+
+		if ((analyses & AudioAnalysisSignature) != 0)
+		{
+			AnalysisPart part;
+			part.type = AudioAnalysisSignature;
+			part.consumer = std::make_unique<SignatureConsumer>(options);
+			parts.push_back(std::move(part));
+		}
+
+		if ((analyses & AudioAnalysisContentHash) != 0)
+		{
+			AnalysisPart part;
+			part.type = AudioAnalysisContentHash;
+			part.consumer = std::make_unique<ContentHashConsumer>();
+			parts.push_back(std::move(part));
+		}
+
+		if ((analyses & AudioAnalysisLoudness) != 0)
+		{
+			AnalysisPart part;
+			part.type = AudioAnalysisLoudness;
+			part.consumer = std::make_unique<LoudnessConsumer>();
+			parts.push_back(std::move(part));
+		}
+
+		if ((analyses & AudioAnalysisProperties) != 0)
+		{
+			AnalysisPart part;
+			part.type = AudioAnalysisProperties;
+			part.consumer = std::make_unique<PropertiesConsumer>();
+			parts.push_back(std::move(part));
+		}
+
+		return parts;
+	}
+
+	void ToFloat(
+		const uint8_t* data,
+		AVSampleFormat format,
+		size_t count,
+		std::vector<float>& output)
+	{
+		output.resize(count);
+
+		switch (format)
+		{
+			case AV_SAMPLE_FMT_U8:
+			{
+				for (size_t index = 0; index < count; index++)
+				{
+					output[index] = (data[index] - 128) / 128.0f;
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S16:
+			{
+				const int16_t* samples =
+					reinterpret_cast<const int16_t*>(data);
+
+				for (size_t index = 0; index < count; index++)
+				{
+					output[index] = samples[index] / 32768.0f;
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S32:
+			{
+				const int32_t* samples =
+					reinterpret_cast<const int32_t*>(data);
+
+				for (size_t index = 0; index < count; index++)
+				{
+					output[index] =
+						static_cast<float>(samples[index] / 2147483648.0);
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S64:
+			{
+				const int64_t* samples =
+					reinterpret_cast<const int64_t*>(data);
+
+				for (size_t index = 0; index < count; index++)
+				{
+					output[index] = static_cast<float>(
+						samples[index] / 9223372036854775808.0);
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_FLT:
+			{
+				const float* samples = reinterpret_cast<const float*>(data);
+
+				std::copy(samples, samples + count, output.begin());
+				break;
+			}
+			case AV_SAMPLE_FMT_DBL:
+			{
+				const double* samples =
+					reinterpret_cast<const double*>(data);
+
+				for (size_t index = 0; index < count; index++)
+				{
+					output[index] = static_cast<float>(samples[index]);
+				}
+				break;
+			}
+			default:
+				std::fill(output.begin(), output.end(), 0.0f);
+				break;
+		}
+	}
+}
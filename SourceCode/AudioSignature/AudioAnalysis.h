@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioReader.h"
+#include "AudioSignature.h"
+
+namespace AudioSignature
+{
+	// Takes its share of a file's decoded audio, alongside any other
+	// consumers, so that the file is decoded once for all of them.  The
+	// audio comes in the decoder's own sample format, packed, at the
+	// source's rate and channels.
+	class AudioConsumer
+	{
+	public:
+		virtual ~AudioConsumer() = default;
+
+		// Called once the file is open, before any audio.  Returns false
+		// if the consumer cannot take the file's audio.
+		virtual bool Begin(const AudioReader& reader) = 0;
+
+		// Takes the next block of audio, with frames counting the samples
+		// per channel.  Returns false if the consumer has failed.
+		virtual bool Consume(const uint8_t* data, size_t frames) = 0;
+
+		// Fills in the consumer's part of the analysis, at the end of the
+		// audio, or once it is done.
+		virtual bool Finish(AudioAnalysis& analysis) = 0;
+
+		// Whether the consumer needs no more of the audio, so that the
+		// decoding can stop early once no consumer does.
+		virtual bool IsDone() const
+		{
+			return false;
+		}
+	};
+}
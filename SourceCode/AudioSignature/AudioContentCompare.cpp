@@ -0,0 +1,233 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "AudioContentCompare.h"
+#include "AudioReader.h"
+#include "AudioSignature.h"
+
+namespace AudioSignature
+{
+	// memcmp is vectorized by every C runtime the library is built with,
+	// so whole blocks are compared by it, and only a block known to differ
+	// is searched byte by byte.
+	const size_t CompareBlockSize = 4096;
+
+	// Holds the decoded bytes of one file not yet compared against the
+	// other, as the two decoders produce blocks of different sizes.
+	struct PendingAudio
+	{
+		AudioReader reader;
+		std::vector<uint8_t> data;
+		size_t position = 0;
+
+		size_t GetSize() const
+		{
+			return data.size() - position;
+		}
+
+		// Reads until there is something to compare, returning false at
+		// the end of the audio or on error.
+		bool Fill()
+		{
+			bool result = GetSize() > 0;
+
+			if (result == false)
+			{
+				data.clear();
+				position = 0;
+
+				const uint8_t* block = nullptr;
+				size_t size = 0;
+
+				while (result == false && reader.ReadBytes(&block, &size))
+				{
+					data.insert(data.end(), block, block + size);
+					result = size > 0;
+				}
+			}
+
+			return result;
+		}
+	};
+
+	int CompareDecodedAudio(
+		PendingAudio& first,
+		PendingAudio& second,
+		AudioContentComparison* comparison);
+	int GetFormatDifferences(
+		const AudioReader& first, const AudioReader& second);
+
+	int CompareDecodedAudio(
+		PendingAudio& first,
+		PendingAudio& second,
+		AudioContentComparison* comparison)
+	{
+		int status = SignatureFailed;
+
+		size_t frameSize =
+			static_cast<size_t>(first.reader.GetChannels()) *
+			av_get_bytes_per_sample(first.reader.GetSampleFormat());
+		uint64_t compared = 0;
+
+		while (true)
+		{
+			bool firstMore = first.Fill();
+			bool secondMore = second.Fill();
+
+			if ((!firstMore && !first.reader.IsFinished()) ||
+				(!secondMore && !second.reader.IsFinished()))
+			{
+				// A decoding error, rather than the end of the audio.
+				break;
+			}
+
+			if (!firstMore || !secondMore)
+			{
+				// Identical so far, and one or both have ended, so they
+				// are only the same if both have.
+				if (firstMore || secondMore)
+				{
+					comparison->mismatchOffset =
+						static_cast<int64_t>(compared / frameSize);
+				}
+
+				status = SignatureSuccess;
+				break;
+			}
+
+			size_t size = std::min(first.GetSize(), second.GetSize());
+			const uint8_t* firstData = first.data.data() + first.position;
+			const uint8_t* secondData =
+				second.data.data() + second.position;
+
+			size_t difference =
+				FindFirstDifference(firstData, secondData, size);
+
+			if (difference < size)
+			{
+				comparison->mismatchOffset =
+					static_cast<int64_t>((compared + difference) / frameSize);
+
+				status = SignatureSuccess;
+				break;
+			}
+
+			first.position += size;
+			second.position += size;
+			compared += size;
+		}
+
+		return status;
+	}
+
+	size_t FindFirstDifference(
+		const uint8_t* first, const uint8_t* second, size_t size)
+	{
+		size_t position = 0;
+
+		while (position < size)
+		{
+			size_t count = std::min(CompareBlockSize, size - position);
+
+			if (memcmp(first + position, second + position, count) != 0)
+			{
+				while (first[position] == second[position])
+				{
+					position++;
+				}
+
+				break;
+			}
+
+			position += count;
+		}
+
+		return position;
+	}
+
+	int GetFormatDifferences(
+		const AudioReader& first, const AudioReader& second)
+	{
+		int differences = AudioFormatSame;
+
+		if (first.GetSampleRate() != second.GetSampleRate())
+		{
+			differences |= AudioFormatSampleRate;
+		}
+
+		if (first.GetChannels() != second.GetChannels())
+		{
+			differences |= AudioFormatChannels;
+		}
+
+		if (first.GetSampleFormat() != second.GetSampleFormat())
+		{
+			differences |= AudioFormatSampleFormat;
+		}
+
+		if (first.GetBitsPerSample() != second.GetBitsPerSample())
+		{
+			differences |= AudioFormatBitsPerSample;
+		}
+
+		return differences;
+	}
+
+	int CompareAudioContent(
+		const char* firstPath,
+		const char* secondPath,
+		AudioContentComparison* comparison)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (firstPath != nullptr && secondPath != nullptr &&
+			comparison != nullptr)
+		{
+			status = SignatureFailed;
+
+			comparison->identical = 0;
+			comparison->mismatchOffset = -1;
+			comparison->formatDifferences = AudioFormatSame;
+
+			// Both decode to their own sample format, packed, so sources
+			// in planar and interleaved codecs, such as ALAC and FLAC,
+			// still compare sample for sample.
+			PendingAudio first;
+			PendingAudio second;
+			first.reader.SetOutputSampleFormat(AV_SAMPLE_FMT_NONE);
+			second.reader.SetOutputSampleFormat(AV_SAMPLE_FMT_NONE);
+
+			if (first.reader.Open(firstPath) && second.reader.Open(secondPath))
+			{
+				comparison->formatDifferences =
+					GetFormatDifferences(first.reader, second.reader);
+
+				// Only the bit depth may differ, as that is just a label
+				// on the same samples.  Anything else and the samples
+				// cannot match, so there is nothing to decode.
+				int blocking = comparison->formatDifferences &
+					~AudioFormatBitsPerSample;
+
+				if (blocking != AudioFormatSame)
+				{
+					comparison->mismatchOffset = 0;
+					status = SignatureSuccess;
+				}
+				else
+				{
+					status =
+						CompareDecodedAudio(first, second, comparison);
+				}
+
+				if (status == SignatureSuccess &&
+					comparison->mismatchOffset < 0)
+				{
+					comparison->identical = 1;
+				}
+			}
+		}
+
+		return status;
+	}
+}
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioSignature
+{
+	// Returns the position of the first differing byte of two buffers, or
+	// size if they are equal.
+	size_t FindFirstDifference(
+		const uint8_t* first, const uint8_t* second, size_t size);
+}
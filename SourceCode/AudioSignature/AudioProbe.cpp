@@ -0,0 +1,204 @@
+﻿#include <algorithm>
+#include <cstring>
+
+extern "C"
+{
+	#include <libavcodec/avcodec.h>
+	#include <libavformat/avformat.h>
+}
+
+#include "AudioSignature.h"
+
+namespace AudioSignature
+{
+	// Enough for libavformat to recognise the container, as the format
+	// comes from the headers, which the demuxers read whatever the size.
+	const int64_t ProbeSize = 32 * 1024;
+
+	// How much audio to parse, in AV_TIME_BASE units, for the containers
+	// whose headers leave the format incomplete.
+	const int64_t ProbeAnalyzeDuration = AV_TIME_BASE / 2;
+
+	int FindAudioStream(AVFormatContext* formatContext);
+	double GetProbeDuration(
+		AVFormatContext* formatContext, const AVStream* stream);
+	bool IsLossless(AVCodecID codecId);
+	void SetProbe(
+		AVFormatContext* formatContext,
+		const AVStream* stream,
+		AudioProbe* probe);
+
+	int ProbeAudioFile(const char* filePath, AudioProbe* probe)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (filePath != nullptr && probe != nullptr)
+		{
+			status = SignatureFailed;
+			*probe = AudioProbe();
+
+			AVFormatContext* formatContext = avformat_alloc_context();
+
+			if (formatContext != nullptr)
+			{
+				formatContext->probesize = ProbeSize;
+				formatContext->max_analyze_duration = ProbeAnalyzeDuration;
+
+				// On failure, the context is freed and set to null.
+				int result = avformat_open_input(
+					&formatContext, filePath, nullptr, nullptr);
+
+				int streamIndex = -1;
+
+				if (result >= 0)
+				{
+					streamIndex = FindAudioStream(formatContext);
+
+					// Only parses the packets if the headers were not
+					// enough, which the tight limits above keep short.
+					if (streamIndex < 0)
+					{
+						result =
+							avformat_find_stream_info(formatContext, nullptr);
+
+						if (result >= 0)
+						{
+							streamIndex = FindAudioStream(formatContext);
+						}
+					}
+				}
+
+				if (streamIndex >= 0)
+				{
+					AVStream* stream = formatContext->streams[streamIndex];
+
+					SetProbe(formatContext, stream, probe);
+					status = SignatureSuccess;
+				}
+
+				avformat_close_input(&formatContext);
+			}
+		}
+
+		return status;
+	}
+
+	int FindAudioStream(AVFormatContext* formatContext)
+	{
+		int streamIndex = av_find_best_stream(
+			formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+
+		if (streamIndex >= 0)
+		{
+			const AVCodecParameters* parameters =
+				formatContext->streams[streamIndex]->codecpar;
+
+			if (parameters->codec_id == AV_CODEC_ID_NONE ||
+				parameters->sample_rate <= 0 ||
+				parameters->ch_layout.nb_channels <= 0)
+			{
+				streamIndex = -1;
+			}
+		}
+
+		return streamIndex;
+	}
+
+	double GetProbeDuration(
+		AVFormatContext* formatContext, const AVStream* stream)
+	{
+		double duration = 0.0;
+
+		if (stream->duration != AV_NOPTS_VALUE && stream->duration > 0)
+		{
+			duration = stream->duration * av_q2d(stream->time_base);
+		}
+		else if (formatContext->duration != AV_NOPTS_VALUE &&
+			formatContext->duration > 0)
+		{
+			duration =
+				static_cast<double>(formatContext->duration) / AV_TIME_BASE;
+		}
+		else if (stream->codecpar->bit_rate > 0 &&
+			formatContext->pb != nullptr)
+		{
+			// As ffprobe estimates constant bit rate files without a
+			// length in their headers, such as MP3s without a Xing tag.
+			// Tags count towards the size, so the length is a little
+			// over.
+			int64_t size = avio_size(formatContext->pb);
+
+			if (size > 0)
+			{
+				duration = size * 8.0 / stream->codecpar->bit_rate;
+			}
+		}
+
+		return duration;
+	}
+
+	bool IsLossless(AVCodecID codecId)
+	{
+		bool lossless = false;
+
+		const AVCodecDescriptor* descriptor =
+			avcodec_descriptor_get(codecId);
+
+		if (descriptor != nullptr &&
+			(descriptor->props & AV_CODEC_PROP_LOSSLESS) != 0 &&
+			(descriptor->props & AV_CODEC_PROP_LOSSY) == 0)
+		{
+			lossless = true;
+		}
+
+		return lossless;
+	}
+
+	void SetProbe(
+		AVFormatContext* formatContext,
+		const AVStream* stream,
+		AudioProbe* probe)
+	{
+		const AVCodecParameters* parameters = stream->codecpar;
+
+		probe->codecId = parameters->codec_id;
+
+		const char* name = avcodec_get_name(parameters->codec_id);
+		size_t size = std::min(strlen(name), sizeof(probe->codec) - 1);
+		std::copy(name, name + size, probe->codec);
+		probe->codec[size] = 0;
+
+		probe->lossless = IsLossless(parameters->codec_id) ? 1 : 0;
+		probe->sampleRate = parameters->sample_rate;
+		probe->channels = parameters->ch_layout.nb_channels;
+
+		// The coded size of a lossy codec's samples says nothing of the
+		// source, so is only used for lossless ones.
+		probe->bitsPerSample = parameters->bits_per_raw_sample;
+
+		if (probe->bitsPerSample <= 0 && probe->lossless != 0)
+		{
+			probe->bitsPerSample = parameters->bits_per_coded_sample;
+		}
+
+		probe->duration = GetProbeDuration(formatContext, stream);
+		probe->bitRate = parameters->bit_rate;
+
+		if (probe->bitRate <= 0)
+		{
+			probe->bitRate = formatContext->bit_rate;
+		}
+
+		if (probe->bitRate <= 0 && probe->duration > 0.0 &&
+			formatContext->pb != nullptr)
+		{
+			int64_t fileSize = avio_size(formatContext->pb);
+
+			if (fileSize > 0)
+			{
+				probe->bitRate =
+					static_cast<int64_t>(fileSize * 8.0 / probe->duration);
+			}
+		}
+	}
+}
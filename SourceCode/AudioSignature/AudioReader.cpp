@@ -0,0 +1,794 @@
+﻿#include <algorithm>
+
+extern "C"
+{
+	#include <libavutil/opt.h>
+}
+
+#include "AudioReader.h"
+#include "SignatureStats.h"
+
+namespace AudioSignature
+{
+	// Corrupt packets are skipped, as the FFmpeg tools do, but a file that
+	// keeps failing is given up on.
+	const int MaximumDecodeErrors = 100;
+
+	// The size of the buffer libavformat reads the mapped file through.
+	const int MappedBufferSize = 64 * 1024;
+
+	bool HasDeadline(std::chrono::steady_clock::time_point deadline);
+	bool HasDeadline(std::chrono::steady_clock::time_point deadline)
+	{
+		return deadline != std::chrono::steady_clock::time_point();
+	}
+
+	int ReadMappedFile(void* opaque, uint8_t* buffer, int size);
+	int64_t SeekMappedFile(void* opaque, int64_t offset, int whence);
+
+	AudioReader::AudioReader()
+	{
+	}
+
+	AudioReader::~AudioReader()
+	{
+		Close();
+	}
+
+	int64_t AudioReader::GetBytesRead() const
+	{
+		int64_t bytesRead = 0;
+
+		if (formatContext != nullptr && formatContext->pb != nullptr)
+		{
+			bytesRead = formatContext->pb->bytes_read;
+		}
+
+		return bytesRead;
+	}
+
+	int AudioReader::GetBitsPerSample() const
+	{
+		return bitsPerSample;
+	}
+
+	int64_t AudioReader::GetBitRate() const
+	{
+		int64_t bitRate = 0;
+
+		if (formatContext != nullptr && formatContext->bit_rate > 0)
+		{
+			bitRate = formatContext->bit_rate;
+		}
+		else if (codecContext != nullptr && codecContext->bit_rate > 0)
+		{
+			bitRate = codecContext->bit_rate;
+		}
+
+		return bitRate;
+	}
+
+	bool AudioReader::GetChannelLayout(AVChannelLayout* layout) const
+	{
+		bool copied = false;
+
+		if (codecContext != nullptr && layout != nullptr)
+		{
+			int result = 0;
+
+			if (codecContext->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC)
+			{
+				av_channel_layout_default(
+					layout, codecContext->ch_layout.nb_channels);
+			}
+			else
+			{
+				result =
+					av_channel_layout_copy(layout, &codecContext->ch_layout);
+			}
+
+			copied = result >= 0;
+		}
+
+		return copied;
+	}
+
+	int AudioReader::GetChannels() const
+	{
+		return channels;
+	}
+
+	std::string AudioReader::GetCodecName() const
+	{
+		std::string codecName;
+
+		if (codecContext != nullptr)
+		{
+			codecName = avcodec_get_name(codecContext->codec_id);
+		}
+
+		return codecName;
+	}
+
+	double AudioReader::GetDuration() const
+	{
+		double duration = 0.0;
+		const AVStream* stream = GetStream();
+
+		if (stream != nullptr &&
+			stream->duration != AV_NOPTS_VALUE &&
+			stream->duration > 0)
+		{
+			duration = stream->duration * av_q2d(stream->time_base);
+		}
+		else if (formatContext != nullptr &&
+			formatContext->duration != AV_NOPTS_VALUE &&
+			formatContext->duration > 0)
+		{
+			duration =
+				static_cast<double>(formatContext->duration) / AV_TIME_BASE;
+		}
+
+		return duration;
+	}
+
+	std::string AudioReader::GetError() const
+	{
+		return error;
+	}
+
+	const AVFormatContext* AudioReader::GetFormatContext() const
+	{
+		return formatContext;
+	}
+
+	ReadInterruption AudioReader::GetInterruption() const
+	{
+		return interruption;
+	}
+
+	std::chrono::nanoseconds AudioReader::GetResampleTime() const
+	{
+		return resampleTime;
+	}
+
+	AVSampleFormat AudioReader::GetSampleFormat() const
+	{
+		return sampleFormat;
+	}
+
+	int AudioReader::GetSampleRate() const
+	{
+		return sampleRate;
+	}
+
+	const AVStream* AudioReader::GetStream() const
+	{
+		const AVStream* stream = nullptr;
+
+		if (formatContext != nullptr && streamIndex >= 0)
+		{
+			stream = formatContext->streams[streamIndex];
+		}
+
+		return stream;
+	}
+
+	bool AudioReader::IsFinished() const
+	{
+		return finished;
+	}
+
+	bool AudioReader::IsOpen() const
+	{
+		return opened;
+	}
+
+	void AudioReader::SetBudget(const ReadBudget& budget)
+	{
+		this->budget = budget;
+	}
+
+	void AudioReader::SetDecoderThreads(int count)
+	{
+		decoderThreads = count;
+	}
+
+	void AudioReader::SetDefaultResampling(bool defaults)
+	{
+		defaultResampling = defaults;
+	}
+
+	void AudioReader::SetDiscardOtherStreams(bool discard)
+	{
+		discardOtherStreams = discard;
+	}
+
+	void AudioReader::SetFastResampling(bool fast)
+	{
+		fastResampling = fast;
+	}
+
+	void AudioReader::SetMemoryMapped(bool mapped)
+	{
+		memoryMapped = mapped;
+	}
+
+	void AudioReader::SetOutputChannels(int count)
+	{
+		outputChannels = count;
+	}
+
+	void AudioReader::SetOutputSampleFormat(AVSampleFormat format)
+	{
+		outputSampleFormat = format;
+	}
+
+	void AudioReader::SetOutputSampleRate(int rate)
+	{
+		outputSampleRate = rate;
+	}
+
+	void AudioReader::Close()
+	{
+		swr_free(&converter);
+		avcodec_free_context(&codecContext);
+		avformat_close_input(&formatContext);
+
+		// With custom I/O, the context and its buffer are ours to free.
+		if (ioContext != nullptr)
+		{
+			av_freep(&ioContext->buffer);
+			avio_context_free(&ioContext);
+		}
+
+		mappedFile.Close();
+		av_packet_free(&packet);
+		av_frame_free(&frame);
+
+		streamIndex = -1;
+		decodeErrors = 0;
+		finished = false;
+		inputFinished = false;
+		opened = false;
+		usingFastResampler = false;
+		bitsPerSample = 0;
+		channels = 0;
+		sampleRate = 0;
+		sampleFormat = AV_SAMPLE_FMT_NONE;
+		resampleTime = std::chrono::nanoseconds::zero();
+	}
+
+	bool AudioReader::Open(const std::string& filePath)
+	{
+		Close();
+
+		error.clear();
+		interruption = ReadInterruption::None;
+
+		if (memoryMapped == true && !OpenMappedInput(filePath))
+		{
+			return false;
+		}
+
+		// The context is made here, rather than by avformat_open_input,
+		// so that the budget covers the probing too.
+		if (formatContext == nullptr)
+		{
+			formatContext = avformat_alloc_context();
+
+			if (formatContext == nullptr)
+			{
+				SetError("Could not allocate the format context");
+				return false;
+			}
+		}
+
+		formatContext->interrupt_callback.callback = InterruptCallback;
+		formatContext->interrupt_callback.opaque = this;
+
+		int result = avformat_open_input(
+			&formatContext, filePath.c_str(), nullptr, nullptr);
+
+		if (result < 0)
+		{
+			SetError("Could not open the input file", result);
+			return false;
+		}
+
+		result = avformat_find_stream_info(formatContext, nullptr);
+
+		if (result < 0)
+		{
+			SetError("Could not find stream information", result);
+			return false;
+		}
+
+		const AVCodec* codec = nullptr;
+
+		result = av_find_best_stream(
+			formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+
+		if (result < 0)
+		{
+			SetError("Could not find any audio stream in the file", result);
+			return false;
+		}
+
+		streamIndex = result;
+		AVStream* stream = formatContext->streams[streamIndex];
+
+		if (discardOtherStreams == true)
+		{
+			for (unsigned int index = 0;
+				index < formatContext->nb_streams;
+				index++)
+			{
+				if (static_cast<int>(index) != streamIndex)
+				{
+					formatContext->streams[index]->discard = AVDISCARD_ALL;
+				}
+			}
+		}
+
+		codecContext = avcodec_alloc_context3(codec);
+
+		if (codecContext == nullptr)
+		{
+			SetError("Could not allocate the codec context");
+			return false;
+		}
+
+		result =
+			avcodec_parameters_to_context(codecContext, stream->codecpar);
+
+		if (result < 0)
+		{
+			SetError("Could not copy the codec parameters", result);
+			return false;
+		}
+
+		// Asking for the output format lets decoders that can produce it
+		// skip a conversion, but asking a high resolution decoder for
+		// less would lose precision.
+		if (outputSampleFormat != AV_SAMPLE_FMT_NONE)
+		{
+			codecContext->request_sample_fmt = outputSampleFormat;
+		}
+
+		// Codecs without threading support simply ignore these.
+		codecContext->thread_count = decoderThreads;
+		codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+		result = avcodec_open2(codecContext, codec, nullptr);
+
+		if (result < 0)
+		{
+			SetError("Could not open the codec", result);
+			return false;
+		}
+
+		frame = av_frame_alloc();
+		packet = av_packet_alloc();
+
+		if (frame == nullptr || packet == nullptr)
+		{
+			SetError("Could not allocate the decoding buffers");
+			return false;
+		}
+
+		bitsPerSample = codecContext->bits_per_raw_sample;
+
+		if (bitsPerSample <= 0)
+		{
+			bitsPerSample =
+				av_get_bytes_per_sample(codecContext->sample_fmt) * 8;
+		}
+
+		channels = codecContext->ch_layout.nb_channels;
+		sampleRate = codecContext->sample_rate;
+
+		if (outputChannels > 0)
+		{
+			channels = outputChannels;
+		}
+
+		if (outputSampleRate > 0)
+		{
+			sampleRate = outputSampleRate;
+		}
+
+		sampleFormat = outputSampleFormat;
+
+		if (sampleFormat == AV_SAMPLE_FMT_NONE)
+		{
+			sampleFormat = av_get_packed_sample_fmt(codecContext->sample_fmt);
+		}
+
+		if (channels <= 0 || sampleRate <= 0 ||
+			sampleFormat == AV_SAMPLE_FMT_NONE)
+		{
+			SetError("Invalid audio format");
+			return false;
+		}
+
+		usingFastResampler = fastResampling == true &&
+			FastResampler::IsSupported(
+				codecContext->sample_fmt,
+				codecContext->ch_layout.nb_channels,
+				codecContext->sample_rate,
+				channels,
+				sampleRate) &&
+			sampleFormat == AV_SAMPLE_FMT_S16;
+
+		if (usingFastResampler == true)
+		{
+			fastResampler.Open(
+				codecContext->sample_fmt,
+				codecContext->ch_layout.nb_channels,
+				codecContext->sample_rate,
+				sampleRate);
+		}
+		else if (!OpenConverter())
+		{
+			return false;
+		}
+
+		opened = true;
+
+		return true;
+	}
+
+	bool AudioReader::Read(const int16_t** data, size_t* size)
+	{
+		*data = nullptr;
+
+		bool result = Decode(size);
+
+		if (result == true)
+		{
+			*data = reinterpret_cast<const int16_t*>(convertBuffer.data());
+		}
+
+		return result;
+	}
+
+	bool AudioReader::ReadBytes(const uint8_t** data, size_t* size)
+	{
+		*data = nullptr;
+
+		bool result = Decode(size);
+
+		if (result == true)
+		{
+			*data = convertBuffer.data();
+			*size *= static_cast<size_t>(channels) *
+				av_get_bytes_per_sample(sampleFormat);
+		}
+
+		return result;
+	}
+
+	bool AudioReader::Convert(
+		const uint8_t** input, int inputSize, size_t* size)
+	{
+		if (usingFastResampler == true)
+		{
+			StageTimer timer(resampleTime);
+
+			*size = fastResampler.Convert(input, inputSize, convertBuffer);
+
+			return true;
+		}
+
+		int outputSize = swr_get_out_samples(converter, inputSize);
+
+		if (outputSize < 0)
+		{
+			SetError("Could not size the converted audio", outputSize);
+			return false;
+		}
+
+		size_t needed = static_cast<size_t>(outputSize) * channels *
+			av_get_bytes_per_sample(sampleFormat);
+
+		if (convertBuffer.size() < needed)
+		{
+			convertBuffer.resize(needed);
+		}
+
+		uint8_t* output = convertBuffer.data();
+		int result;
+
+		{
+			StageTimer timer(resampleTime);
+
+			result =
+				swr_convert(converter, &output, outputSize, input, inputSize);
+		}
+
+		if (result < 0)
+		{
+			SetError("Could not convert the audio", result);
+			return false;
+		}
+
+		*size = static_cast<size_t>(result);
+
+		return true;
+	}
+
+	bool AudioReader::Decode(size_t* size)
+	{
+		*size = 0;
+
+		if (opened == false || finished == true)
+		{
+			return false;
+		}
+
+		while (true)
+		{
+			// Checked on every pass, as a corrupt stream can keep the
+			// decoder busy without ever reading from the input.
+			if (IsInterrupted())
+			{
+				SetError("The read was stopped early");
+				return false;
+			}
+
+			int result = avcodec_receive_frame(codecContext, frame);
+
+			if (result == 0)
+			{
+				bool converted = Convert(
+					const_cast<const uint8_t**>(frame->extended_data),
+					frame->nb_samples,
+					size);
+
+				av_frame_unref(frame);
+
+				return converted;
+			}
+			else if (result == AVERROR_EOF)
+			{
+				// Drain whatever the resampler is still holding.
+				finished = true;
+
+				bool converted = Convert(nullptr, 0, size);
+
+				return converted;
+			}
+			else if (result != AVERROR(EAGAIN))
+			{
+				SetError("Error decoding audio frame", result);
+				return false;
+			}
+
+			if (inputFinished == true)
+			{
+				// Already flushing, so the decoder should not need more.
+				SetError("The decoder did not finish", result);
+				return false;
+			}
+
+			result = av_read_frame(formatContext, packet);
+
+			if (result == AVERROR_EOF)
+			{
+				inputFinished = true;
+
+				avcodec_send_packet(codecContext, nullptr);
+			}
+			else if (result < 0)
+			{
+				SetError("Error reading from the audio source", result);
+				return false;
+			}
+			else
+			{
+				if (packet->stream_index == streamIndex)
+				{
+					result = avcodec_send_packet(codecContext, packet);
+
+					if (result < 0 && result != AVERROR(EAGAIN))
+					{
+						decodeErrors++;
+
+						if (decodeErrors > MaximumDecodeErrors)
+						{
+							av_packet_unref(packet);
+							SetError("Too many decoding errors", result);
+							return false;
+						}
+					}
+				}
+
+				av_packet_unref(packet);
+			}
+		}
+	}
+
+	bool AudioReader::IsInterrupted()
+	{
+		if (interruption == ReadInterruption::None)
+		{
+			if (budget.cancelled != nullptr && budget.cancelled->load())
+			{
+				interruption = ReadInterruption::Cancelled;
+			}
+			else if (HasDeadline(budget.deadline) &&
+				std::chrono::steady_clock::now() >= budget.deadline)
+			{
+				interruption = ReadInterruption::TimedOut;
+			}
+			else if (budget.maxBytesRead > 0 &&
+				GetBytesRead() > budget.maxBytesRead)
+			{
+				interruption = ReadInterruption::ReadLimit;
+			}
+		}
+
+		return interruption != ReadInterruption::None;
+	}
+
+	bool AudioReader::OpenConverter()
+	{
+		AVChannelLayout inputLayout{};
+		AVChannelLayout outputLayout;
+
+		GetChannelLayout(&inputLayout);
+		av_channel_layout_default(&outputLayout, channels);
+
+		int result = swr_alloc_set_opts2(
+			&converter,
+			&outputLayout,
+			sampleFormat,
+			sampleRate,
+			&inputLayout,
+			codecContext->sample_fmt,
+			codecContext->sample_rate,
+			0,
+			nullptr);
+
+		av_channel_layout_uninit(&inputLayout);
+		av_channel_layout_uninit(&outputLayout);
+
+		if (result < 0)
+		{
+			SetError("Could not allocate the audio converter", result);
+			return false;
+		}
+
+		if (defaultResampling == false)
+		{
+			SetCompatibleResampling(converter);
+		}
+
+		result = swr_init(converter);
+
+		if (result < 0)
+		{
+			SetError("Could not initialize the audio converter", result);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool AudioReader::OpenMappedInput(const std::string& filePath)
+	{
+		if (!mappedFile.Open(filePath))
+		{
+			SetError("Could not map the input file");
+			return false;
+		}
+
+		unsigned char* buffer =
+			static_cast<unsigned char*>(av_malloc(MappedBufferSize));
+
+		if (buffer == nullptr)
+		{
+			SetError("Could not allocate the input buffer");
+			return false;
+		}
+
+		ioContext = avio_alloc_context(
+			buffer,
+			MappedBufferSize,
+			0,
+			&mappedFile,
+			ReadMappedFile,
+			nullptr,
+			SeekMappedFile);
+
+		if (ioContext == nullptr)
+		{
+			av_free(buffer);
+			SetError("Could not allocate the input context");
+			return false;
+		}
+
+		formatContext = avformat_alloc_context();
+
+		if (formatContext == nullptr)
+		{
+			SetError("Could not allocate the format context");
+			return false;
+		}
+
+		formatContext->pb = ioContext;
+		formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+		return true;
+	}
+
+	int AudioReader::InterruptCallback(void* opaque)
+	{
+		AudioReader* reader = static_cast<AudioReader*>(opaque);
+
+		int interrupted = reader->IsInterrupted() ? 1 : 0;
+
+		return interrupted;
+	}
+
+	void AudioReader::SetError(const std::string& message, int errorCode)
+	{
+		error = message;
+
+		if (errorCode < 0)
+		{
+			char buffer[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+			av_strerror(errorCode, buffer, sizeof(buffer));
+
+			error += " (";
+			error += buffer;
+			error += ")";
+		}
+	}
+
+	int ReadMappedFile(void* opaque, uint8_t* buffer, int size)
+	{
+		MappedFile* mappedFile = static_cast<MappedFile*>(opaque);
+
+		int count = mappedFile->Read(buffer, size);
+
+		if (count == 0)
+		{
+			count = AVERROR_EOF;
+		}
+
+		return count;
+	}
+
+	int64_t SeekMappedFile(void* opaque, int64_t offset, int whence)
+	{
+		MappedFile* mappedFile = static_cast<MappedFile*>(opaque);
+		int64_t result;
+
+		if ((whence & AVSEEK_SIZE) != 0)
+		{
+			result = mappedFile->GetSize();
+		}
+		else
+		{
+			result = mappedFile->Seek(offset, whence & ~AVSEEK_FORCE);
+
+			if (result < 0)
+			{
+				result = AVERROR(EINVAL);
+			}
+		}
+
+		return result;
+	}
+
+	void SetCompatibleResampling(SwrContext* converter)
+	{
+		av_opt_set_int(converter, "resampler", SWR_ENGINE_SWR, 0);
+		av_opt_set_int(converter, "filter_size", 16, 0);
+		av_opt_set_int(converter, "phase_shift", 8, 0);
+		av_opt_set_int(converter, "linear_interp", 1, 0);
+		av_opt_set_double(converter, "cutoff", 0.8, 0);
+	}
+}
@@ -0,0 +1,196 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+	#include <libavcodec/avcodec.h>
+	#include <libavformat/avformat.h>
+	#include <libswresample/swresample.h>
+}
+
+#include "FastResampler.h"
+#include "MappedFile.h"
+
+namespace AudioSignature
+{
+	// Why a read was stopped early, if it was.
+	enum class ReadInterruption
+	{
+		None,
+		Cancelled,
+		TimedOut,
+		ReadLimit
+	};
+
+	// Limits on how long, and how much, a file may be read for, so that a
+	// corrupt file cannot hold a worker indefinitely.
+	struct ReadBudget
+	{
+		// Stops the read once set, from any thread.
+		const std::atomic<bool>* cancelled = nullptr;
+
+		// When to stop, or the epoch for no deadline.
+		std::chrono::steady_clock::time_point deadline{};
+
+		// The most bytes to read from the input, or zero for no limit.
+		int64_t maxBytesRead = 0;
+	};
+
+	// Sets a converter up as chromaprint does in its compatible mode, so
+	// that the fingerprints match those from fpcalc.
+	void SetCompatibleResampling(SwrContext* converter);
+
+	// Decodes the audio stream of a file into interleaved samples, by
+	// default 16 bit, converted to the requested sample rate and channel
+	// count.  This follows chromaprint's FFmpegAudioReader, but owns the
+	// demuxer context, so that how the file is read can be tuned here.
+	class AudioReader
+	{
+	public:
+		AudioReader();
+		~AudioReader();
+
+		AudioReader(const AudioReader&) = delete;
+		AudioReader& operator=(const AudioReader&) = delete;
+
+		// The number of bytes read from the input so far.
+		int64_t GetBytesRead() const;
+
+		// The bit depth of the source audio, where the codec records it,
+		// otherwise that of the decoded samples.
+		int GetBitsPerSample() const;
+
+		// The bit rate of the file, as the container or codec records it,
+		// or zero if neither does.
+		int64_t GetBitRate() const;
+
+		// Copies the source's channel layout, with the default layout for
+		// its channel count if the order is unspecified.  The layout must
+		// be released with av_channel_layout_uninit.
+		bool GetChannelLayout(AVChannelLayout* layout) const;
+		int GetChannels() const;
+
+		// The FFmpeg name of the audio codec, once open.
+		std::string GetCodecName() const;
+
+		// The length of the audio in seconds, as the container's headers
+		// give it, or zero if they do not.
+		double GetDuration() const;
+		std::string GetError() const;
+
+		// The demuxer and the selected audio stream, once open, for the
+		// file's tags and attached pictures.
+		const AVFormatContext* GetFormatContext() const;
+		const AVStream* GetStream() const;
+
+		// Why the last open or read was stopped early, if it was.
+		ReadInterruption GetInterruption() const;
+		AVSampleFormat GetSampleFormat() const;
+		int GetSampleRate() const;
+
+		// The time spent converting samples since the file was opened.
+		std::chrono::nanoseconds GetResampleTime() const;
+		bool IsFinished() const;
+		bool IsOpen() const;
+
+		// The limits for the files opened from now on.  They are checked
+		// by FFmpeg's interrupt callback while it reads, and before each
+		// frame is decoded.
+		void SetBudget(const ReadBudget& budget);
+
+		// The threads the decoder may use, for codecs with frame or slice
+		// threading, such as FLAC and ALAC.  One, the default, decodes on
+		// the calling thread alone, and zero lets FFmpeg pick from the
+		// processor count.
+		void SetDecoderThreads(int count);
+
+		// When set, swresample is left at its own defaults, as the ffmpeg
+		// command line leaves it, rather than set up as fpcalc does, so
+		// that converted samples match ffmpeg's.  Off by default.
+		void SetDefaultResampling(bool defaults);
+
+		// When set, which is the default, every stream other than the
+		// selected audio stream is discarded by the demuxer, so the
+		// packets of video and other streams are skipped rather than
+		// read.
+		void SetDiscardOtherStreams(bool discard);
+
+		// When set, 44.1 and 48 kHz mono or stereo input going to 16 bit
+		// mono 11025 Hz is converted by FastResampler, rather than by
+		// swresample.
+		void SetFastResampling(bool fast);
+
+		// When set, the file is memory mapped and served to libavformat
+		// through a custom I/O context, instead of being read through
+		// FFmpeg's own file protocol.
+		void SetMemoryMapped(bool mapped);
+		void SetOutputChannels(int count);
+
+		// The packed sample format to convert to, 16 bit by default.
+		// AV_SAMPLE_FMT_NONE keeps the decoder's own format, packed, so
+		// that no precision is lost.
+		void SetOutputSampleFormat(AVSampleFormat format);
+		void SetOutputSampleRate(int rate);
+
+		void Close();
+		bool Open(const std::string& filePath);
+
+		// Reads the next block, with size counting samples per channel.
+		// Only for the 16 bit output format.
+		bool Read(const int16_t** data, size_t* size);
+
+		// Reads the next block in the output format, with size counting
+		// bytes.
+		bool ReadBytes(const uint8_t** data, size_t* size);
+
+	private:
+		bool Convert(const uint8_t** input, int inputSize, size_t* size);
+		bool Decode(size_t* size);
+		bool IsInterrupted();
+		bool OpenConverter();
+		bool OpenMappedInput(const std::string& filePath);
+		void SetError(const std::string& message, int errorCode = 0);
+
+		static int InterruptCallback(void* opaque);
+
+		AVCodecContext* codecContext = nullptr;
+		AVFormatContext* formatContext = nullptr;
+		AVFrame* frame = nullptr;
+		AVIOContext* ioContext = nullptr;
+		AVPacket* packet = nullptr;
+		SwrContext* converter = nullptr;
+		FastResampler fastResampler;
+		std::vector<uint8_t> convertBuffer;
+		std::chrono::nanoseconds resampleTime{};
+		MappedFile mappedFile;
+		ReadBudget budget;
+		ReadInterruption interruption = ReadInterruption::None;
+
+		int streamIndex = -1;
+		int decoderThreads = 1;
+		int decodeErrors = 0;
+		bool defaultResampling = false;
+		bool discardOtherStreams = true;
+		bool fastResampling = false;
+		bool finished = false;
+		bool inputFinished = false;
+		bool memoryMapped = false;
+		bool opened = false;
+		bool usingFastResampler = false;
+
+		int bitsPerSample = 0;
+		int channels = 0;
+		int sampleRate = 0;
+		int outputChannels = 0;
+		int outputSampleRate = 0;
+		AVSampleFormat outputSampleFormat = AV_SAMPLE_FMT_S16;
+		AVSampleFormat sampleFormat = AV_SAMPLE_FMT_NONE;
+
+		std::string error;
+	};
+}
@@ -1,74 +1,1236 @@
-﻿#include <filesystem>
+﻿#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #pragma warning( push )
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/stdout_sinks.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
-#define USE_SWRESAMPLE
 #include "../ChromaPrint/src/chromaprint.h"
-#include "../ChromaPrint/src/audio/ffmpeg_audio_reader.h"
 #pragma warning(pop)
 
+#include "AudioReader.h"
 #include "AudioSignature.h"
+#include "Sha256.h"
+#include "SignatureCache.h"
+#include "SignatureInternal.h"
+#include "SignatureStats.h"
+#include "WorkerPool.h"
 
-using namespace chromaprint;
+namespace AudioSignature
+{
+	// Called each time a fingerprint has been completed, with the context
+	// holding it.  Returns false if the fingerprint could not be taken.
+	using FingerprintHandler =
+		std::function<bool(bool first, double timestamp, double duration)>;
+
+	// Set by CancelSignature, and watched by the readers of the calls
+	// given it.
+	class SignatureCancellation
+	{
+	public:
+		std::atomic<bool> cancelled = false;
+	};
+
+	char* GetAudioSignatureInternal(
+		ChromaprintContext* context,
+		AudioReader& reader,
+		bool first,
+		double timestamp,
+		double duration,
+		spdlog::logger& log);
+	size_t GetFirstPartSize(
+		size_t frameSize,
+		size_t chunkLimit,
+		size_t extraChunkLimit,
+		size_t chunkSize);
+	size_t GetFrameSize(
+		size_t streamLimit, size_t streamSize, size_t frameSize);
+	int GetRawAudioSignatureInternal(
+		ChromaprintContext* context,
+		bool first,
+		uint32_t* buffer,
+		size_t bufferSize,
+		size_t* length,
+		spdlog::logger& log);
+	bool IsStreamDone(size_t streamLimit, size_t streamSize, size_t frameSize);
+	std::shared_ptr<spdlog::logger> MakeLogger(
+		spdlog::level::level_enum level, const char* logPath);
+	int ProcessFile(
+		ChromaprintContext* context,
+		AudioReader& reader,
+		const char* filePath,
+		const SignatureOptions& options,
+		spdlog::logger& logger,
+		const FingerprintHandler& handler);
+
+	// Fingerprints audio that the caller has already decoded, and pushes
+	// in as interleaved 16 bit samples.  Chromaprint itself downmixes and
+	// resamples it to the rate it needs.
+	class SignatureStream
+	{
+	public:
+		SignatureStream()
+			: context(chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT))
+		{
+		}
+
+		~SignatureStream()
+		{
+			chromaprint_free(context);
+		}
+
+		SignatureStream(const SignatureStream&) = delete;
+		SignatureStream& operator=(const SignatureStream&) = delete;
+
+		bool Begin(int sampleRate, int channels)
+		{
+			started = chromaprint_start(context, sampleRate, channels) != 0;
+
+			if (started == false)
+			{
+				GetLogger()->error(
+					"Could not initialize the audio signature process");
+			}
+
+			return started;
+		}
+
+		int Feed(const int16_t* data, size_t size)
+		{
+			int status = SignatureInvalidArgument;
+
+			if (started == true && (data != nullptr || size == 0))
+			{
+				status = SignatureSuccess;
+
+				// chromaprint_feed takes an int count, so very large
+				// buffers are passed through in pieces.
+				const size_t pieceLimit = 1 << 20;
+
+				while (size > 0)
+				{
+					size_t piece = std::min(size, pieceLimit);
+					int length = static_cast<int>(piece);
+
+					if (chromaprint_feed(context, data, length) == 0)
+					{
+						GetLogger()->error("Could not process audio data");
+						status = SignatureFailed;
+						break;
+					}
+
+					data += piece;
+					size -= piece;
+				}
+			}
+
+			return status;
+		}
+
+		char* Finish()
+		{
+			char* audioSignature = nullptr;
+			std::shared_ptr<spdlog::logger> logger = GetLogger();
+
+			if (started == false)
+			{
+				logger->error("The audio signature stream was not started");
+			}
+			else if (!chromaprint_finish(context))
+			{
+				logger->error("Could not finish the audio signtature process");
+			}
+			else
+			{
+				int size = 0;
+				int result =
+					chromaprint_get_raw_fingerprint_size(context, &size);
+
+				if (result == 0 || size <= 0)
+				{
+					logger->error("Not enough audio data");
+				}
+				else if (!chromaprint_get_fingerprint(context, &audioSignature))
+				{
+					logger->error("Could not get the fingerprinting");
+				}
+			}
+
+			return audioSignature;
+		}
+
+	private:
+		ChromaprintContext* context;
+		bool started = false;
+	};
+
+	// The process wide logger, shared by all sessions and threads.  It is
+	// created on first use, or by InitializeLogging, and writes through a
+	// background thread so that callers never wait on the log file.  As
+	// with the worker pool, neither is ever destroyed, as joining the
+	// thread while the library is being unloaded can deadlock on Windows.
+	std::mutex loggerMutex;
+	std::shared_ptr<spdlog::details::thread_pool>& loggerThreadPool =
+		*new std::shared_ptr<spdlog::details::thread_pool>();
+	std::shared_ptr<spdlog::logger>& sharedLogger =
+		*new std::shared_ptr<spdlog::logger>();
+
+	// Keeps the chromaprint context, with its FFT and classifier state,
+	// and the reader alive between files, so that their setup cost is
+	// paid once per session rather than once per file.
+	class SignatureSession
+	{
+	public:
+		SignatureSession()
+		{
+			GetDefaultSignatureOptions(&options);
+
+			context = chromaprint_new(options.algorithm);
+		}
+
+		~SignatureSession()
+		{
+			reader.Close();
+			chromaprint_free(context);
+		}
+
+		SignatureSession(const SignatureSession&) = delete;
+		SignatureSession& operator=(const SignatureSession&) = delete;
+
+		double GetDuration() const
+		{
+			return lastDuration;
+		}
+
+		int GetStatus() const
+		{
+			return lastStatus;
+		}
+
+		char* Run(const char* filePath)
+		{
+			char* audioSignature = nullptr;
+			int status = SignatureSuccess;
+			lastDuration = 0.0;
+			SignatureOptions wholeOptions = GetWholeStreamOptions();
+			SignatureCache& cache = GetSignatureCache();
+
+			// The key is taken before decoding, so a file changed while
+			// being read is cached under its old time, and read again next
+			// time.
+			SignatureCacheKey key;
+			bool cacheable = cache.IsOpen() &&
+				SignatureCache::GetKey(filePath, wholeOptions, key);
+
+			if (cacheable == true)
+			{
+				audioSignature = cache.Find(key);
+			}
+
+			if (audioSignature == nullptr)
+			{
+				std::shared_ptr<spdlog::logger> logger = GetLogger();
+
+				auto handler =
+					[&](bool first, double timestamp, double duration)
+				{
+					audioSignature = GetAudioSignatureInternal(
+						context, reader, first, timestamp, duration, *logger);
+
+					return audioSignature != nullptr;
+				};
+
+				status = ProcessFile(context,
+					reader,
+					filePath,
+					wholeOptions,
+					*logger,
+					handler);
+				lastDuration = reader.GetDuration();
+
+				if (cacheable == true && audioSignature != nullptr)
+				{
+					cache.Store(key, audioSignature);
+				}
+			}
+
+			lastStatus = status;
+
+			return audioSignature;
+		}
+
+		int RunChunks(
+			const char* filePath, SignatureChunk** chunks, size_t* count)
+		{
+			int status = SignatureInvalidArgument;
+
+			if (chunks != nullptr && count != nullptr)
+			{
+				status = SignatureFailed;
+				*chunks = nullptr;
+				*count = 0;
+
+				std::vector<SignatureChunk> results;
+				std::shared_ptr<spdlog::logger> logger = GetLogger();
+
+				auto handler = [&](bool first, double timestamp, double duration)
+				{
+					SignatureChunk chunk;
+					chunk.timestamp = timestamp;
+					chunk.duration = duration;
+					chunk.audioSignature = GetAudioSignatureInternal(
+						context, reader, first, timestamp, duration, *logger);
+
+					results.push_back(chunk);
+
+					return chunk.audioSignature != nullptr;
+				};
+
+				int processed = ProcessFile(
+					context, reader, filePath, options, *logger, handler);
+				lastDuration = reader.GetDuration();
+
+				if (processed != SignatureSuccess)
+				{
+					status = processed;
+				}
+				else if (!results.empty())
+				{
+					size_t size = results.size() * sizeof(SignatureChunk);
+					*chunks = static_cast<SignatureChunk*>(malloc(size));
+
+					if (*chunks != nullptr)
+					{
+						std::copy(results.begin(), results.end(), *chunks);
+						*count = results.size();
+						status = SignatureSuccess;
+					}
+				}
+
+				if (status != SignatureSuccess)
+				{
+					for (SignatureChunk& chunk : results)
+					{
+						FreeAudioSignature(chunk.audioSignature);
+					}
+				}
+			}
+
+			lastStatus = status;
+
+			return status;
+		}
+
+		int RunRaw(
+			const char* filePath,
+			uint32_t* buffer,
+			size_t bufferSize,
+			size_t* length,
+			int* algorithm)
+		{
+			int status = SignatureInvalidArgument;
+
+			if (length != nullptr && (buffer != nullptr || bufferSize == 0))
+			{
+				status = SignatureFailed;
+				*length = 0;
+
+				std::shared_ptr<spdlog::logger> logger = GetLogger();
+
+				auto handler = [&](bool first, double, double)
+				{
+					status = GetRawAudioSignatureInternal(
+						context, first, buffer, bufferSize, length, *logger);
+
+					return status == SignatureSuccess;
+				};
+
+				int processed = ProcessFile(context,
+					reader,
+					filePath,
+					GetWholeStreamOptions(),
+					*logger,
+					handler);
+				lastDuration = reader.GetDuration();
+
+				// Keeps a too small buffer, but says why no fingerprint
+				// was taken at all.
+				if (status == SignatureFailed)
+				{
+					status = processed;
+				}
+
+				if (algorithm != nullptr)
+				{
+					*algorithm = chromaprint_get_algorithm(context);
+				}
+			}
+
+			lastStatus = status;
+
+			return status;
+		}
+
+		int RunToBuffer(
+			const char* filePath,
+			char* buffer,
+			size_t bufferSize,
+			size_t* length)
+		{
+			int status = SignatureInvalidArgument;
+
+			if (length != nullptr && (buffer != nullptr || bufferSize == 0))
+			{
+				*length = 0;
+
+				// The signature is still made by chromaprint, but it is
+				// freed here, on the heap it came from.
+				char* audioSignature = Run(filePath);
+				status = lastStatus;
+
+				if (audioSignature == nullptr)
+				{
+					if (status == SignatureSuccess)
+					{
+						status = SignatureFailed;
+					}
+				}
+				else
+				{
+					size_t size = strlen(audioSignature);
+					*length = size;
+
+					if (size >= bufferSize)
+					{
+						status = SignatureBufferTooSmall;
+					}
+					else
+					{
+						std::copy(
+							audioSignature, audioSignature + size + 1, buffer);
+						status = SignatureSuccess;
+					}
+
+					FreeAudioSignature(audioSignature);
+				}
+			}
+
+			lastStatus = status;
+
+			return status;
+		}
+
+		int SetOptions(const SignatureOptions* newOptions)
+		{
+			int status = SignatureInvalidArgument;
+
+			if (IsValidOptions(newOptions))
+			{
+				if (newOptions->algorithm != options.algorithm)
+				{
+					chromaprint_free(context);
+					context = chromaprint_new(newOptions->algorithm);
+				}
+
+				options = *newOptions;
+				status = SignatureSuccess;
+			}
+
+			return status;
+		}
+
+	private:
+		// The single fingerprint calls take one fingerprint over the
+		// whole of the capped stream, so chunking does not apply to them.
+		SignatureOptions GetWholeStreamOptions() const
+		{
+			SignatureOptions wholeOptions = options;
+			wholeOptions.maxChunkDuration = 0;
+			wholeOptions.overlap = 0;
+
+			return wholeOptions;
+		}
+
+		ChromaprintContext* context;
+		SignatureOptions options;
+		AudioReader reader;
+
+		// The container's length of the last file decoded, or zero.
+		double lastDuration = 0.0;
+		int lastStatus = SignatureSuccess;
+	};
+
+	void CancelSignature(SignatureCancellation* cancellation)
+	{
+		if (cancellation != nullptr)
+		{
+			cancellation->cancelled = true;
+		}
+	}
+
+	SignatureCancellation* CreateSignatureCancellation()
+	{
+		return new SignatureCancellation();
+	}
+
+	SignatureSession* CreateSignatureSession()
+	{
+		return new SignatureSession();
+	}
+
+	void DestroySignatureCancellation(SignatureCancellation* cancellation)
+	{
+		delete cancellation;
+	}
+
+	void DestroySignatureSession(SignatureSession* session)
+	{
+		delete session;
+	}
+
+	void FreeAudioSignature(char* data)
+	{
+		if (data != nullptr)
+		{
+			free(data);
+		}
+	}
+
+	void FreeAudioSignatureBatch(char** results)
+	{
+		// The signatures share the one block with the pointers.
+		if (results != nullptr)
+		{
+			free(results);
+		}
+	}
+
+	void FreeAudioSignatureChunks(SignatureChunk* chunks, size_t count)
+	{
+		if (chunks != nullptr)
+		{
+			for (size_t index = 0; index < count; index++)
+			{
+				FreeAudioSignature(chunks[index].audioSignature);
+			}
+
+			free(chunks);
+		}
+	}
+
+	void GetDefaultSignatureOptions(SignatureOptions* options)
+	{
+		if (options != nullptr)
+		{
+			// The fpcalc defaults
+			options->maxDuration = 120;
+			options->maxChunkDuration = 0;
+			options->overlap = 0;
+			options->algorithm = CHROMAPRINT_ALGORITHM_DEFAULT;
+			options->startOffset = 0.0;
+			options->inputMode = SignatureInputFile;
+			options->resampleMode = SignatureResampleCompatible;
+			options->decoderThreads = 1;
+			options->timeout = 0.0;
+			options->maxBytesRead = 0;
+			options->cancellation = nullptr;
+		}
+	}
+
+	char* GetAudioContentHash(const char* filePath, bool normalize)
+	{
+		char* contentHash = nullptr;
+
+		if (filePath != nullptr)
+		{
+			std::shared_ptr<spdlog::logger> logger = GetLogger();
+
+			AudioReader reader;
+
+			if (normalize == true)
+			{
+				// The same as ffmpeg -f s16le -ar 44100 -ac 2, which
+				// converts with swresample's defaults, rather than the
+				// settings fpcalc uses.
+				reader.SetDefaultResampling(true);
+				reader.SetOutputChannels(2);
+				reader.SetOutputSampleRate(44100);
+			}
+			else
+			{
+				reader.SetOutputSampleFormat(AV_SAMPLE_FMT_NONE);
+			}
+
+			if (!reader.Open(filePath))
+			{
+				logger->error("ERROR: {}", reader.GetError());
+			}
+			else
+			{
+				Sha256 hash;
+				const uint8_t* data = nullptr;
+				size_t size = 0;
+
+				while (reader.ReadBytes(&data, &size))
+				{
+					hash.Update(data, size);
+				}
+
+				if (!reader.IsFinished())
+				{
+					logger->error("ERROR: {}", reader.GetError());
+				}
+				else
+				{
+					std::string digest = hash.Finish();
+
+					contentHash =
+						static_cast<char*>(malloc(digest.size() + 1));
+
+					if (contentHash != nullptr)
+					{
+						std::copy(digest.begin(), digest.end(), contentHash);
+						contentHash[digest.size()] = 0;
+					}
+				}
+			}
+		}
+
+		return contentHash;
+	}
+
+	char* GetAudioSignature(const char* filePath)
+	{
+		SignatureSession session;
+
+		char* result = session.Run(filePath);
+
+		return result;
+	}
+
+	int GetAudioSignatureAsync(
+		const char* filePath,
+		const SignatureOptions* options,
+		SignatureCallback callback,
+		void* userData)
+	{
+		int status = SignatureInvalidArgument;
+
+		SignatureOptions jobOptions;
+		GetDefaultSignatureOptions(&jobOptions);
+
+		if (options != nullptr)
+		{
+			jobOptions = *options;
+		}
+
+		if (filePath != nullptr && callback != nullptr &&
+			IsValidOptions(&jobOptions))
+		{
+			// The path and options are copied, as the caller's may be gone
+			// by the time the job runs.
+			std::string path = filePath;
+
+			auto job = [path, jobOptions, callback, userData]()
+			{
+				// Each pool thread keeps its own session for good, so the
+				// setup cost is paid once per thread.
+				thread_local SignatureSession session;
+
+				char* result = nullptr;
+
+				int jobStatus = session.SetOptions(&jobOptions);
+
+				if (jobStatus == SignatureSuccess)
+				{
+					result = session.Run(path.c_str());
+					jobStatus = session.GetStatus();
+				}
+
+				callback(jobStatus, result, userData);
+			};
+
+			GetWorkerPool().Submit(job);
+
+			status = SignatureSuccess;
+		}
+
+		return status;
+	}
+
+	int GetAudioSignatureBatch(
+		const char** filePaths,
+		size_t count,
+		int threadCount,
+		char*** results)
+	{
+		int successCount = 0;
+
+		if (results != nullptr)
+		{
+			*results = nullptr;
+		}
+
+		if (filePaths != nullptr && results != nullptr && count > 0)
+		{
+			std::vector<char*> signatures(count);
+
+			successCount = GetAudioSignatures(
+				filePaths, count, signatures.data(), threadCount);
+
+			// The pointers come first, so the block is aligned for them,
+			// then each signature in turn.
+			std::vector<size_t> sizes(count, 0);
+			size_t pointersSize = count * sizeof(char*);
+			size_t blockSize = pointersSize;
+
+			for (size_t index = 0; index < count; index++)
+			{
+				if (signatures[index] != nullptr)
+				{
+					sizes[index] = strlen(signatures[index]) + 1;
+					blockSize += sizes[index];
+				}
+			}
+
+			char* block = static_cast<char*>(malloc(blockSize));
+
+			if (block == nullptr)
+			{
+				successCount = 0;
+			}
+			else
+			{
+				char** pointers = reinterpret_cast<char**>(block);
+				char* next = block + pointersSize;
+
+				for (size_t index = 0; index < count; index++)
+				{
+					pointers[index] = nullptr;
+
+					if (signatures[index] != nullptr)
+					{
+						std::copy(signatures[index],
+							signatures[index] + sizes[index],
+							next);
+
+						pointers[index] = next;
+						next += sizes[index];
+					}
+				}
+
+				*results = pointers;
+			}
+
+			for (char* signature : signatures)
+			{
+				FreeAudioSignature(signature);
+			}
+		}
+
+		return successCount;
+	}
+
+	int GetAudioSignatureChunks(
+		const char* filePath,
+		const SignatureOptions* options,
+		SignatureChunk** chunks,
+		size_t* count)
+	{
+		SignatureSession session;
+
+		int status = session.SetOptions(options);
+
+		if (status == SignatureSuccess)
+		{
+			status = session.RunChunks(filePath, chunks, count);
+		}
+
+		return status;
+	}
+
+	int GetAudioSignatureToBuffer(
+		const char* filePath,
+		const SignatureOptions* options,
+		char* buffer,
+		size_t bufferSize,
+		size_t* length)
+	{
+		SignatureSession session;
+
+		int status = SignatureSuccess;
+
+		if (options != nullptr)
+		{
+			status = session.SetOptions(options);
+		}
+
+		if (status == SignatureSuccess)
+		{
+			status =
+				session.RunToBuffer(filePath, buffer, bufferSize, length);
+		}
+
+		return status;
+	}
+
+	char* GetAudioSignatureWithOptions(
+		const char* filePath, const SignatureOptions* options)
+	{
+		char* result = nullptr;
+
+		SignatureSession session;
+
+		if (session.SetOptions(options) == SignatureSuccess)
+		{
+			result = session.Run(filePath);
+		}
+
+		return result;
+	}
+
+	int GetAudioSignatures(
+		const char** filePaths,
+		size_t count,
+		char** results,
+		int threadCount)
+	{
+		std::atomic<int> successCount = 0;
+
+		if (filePaths != nullptr && results != nullptr && count > 0)
+		{
+			std::fill(results, results + count, nullptr);
+
+			std::atomic<size_t> nextIndex = 0;
+
+			size_t workerCount = GetWorkerCount(threadCount, count);
+
+			// A short list, such as one album, would leave processors
+			// idle, so they go to the decoders of the codecs that can
+			// use them instead.  A caller giving its own thread count
+			// is keeping to it, so gets one decoder thread per worker.
+			SignatureOptions options;
+			GetDefaultSignatureOptions(&options);
+
+			size_t processorCount = std::thread::hardware_concurrency();
+
+			if (threadCount <= 0 && processorCount > workerCount)
+			{
+				options.decoderThreads =
+					static_cast<int>(processorCount / workerCount);
+			}
+
+			// Each worker owns its own session, as neither the context nor
+			// the reader is safe to share, and pulls the next unclaimed
+			// index until the list is exhausted.  Results land in their
+			// input slot, so the order is kept regardless of which worker
+			// finishes first.
+			auto worker = [&]()
+			{
+				SignatureSession session;
+				session.SetOptions(&options);
+
+				size_t index = nextIndex++;
+
+				while (index < count)
+				{
+					char* result = session.Run(filePaths[index]);
+
+					if (result != nullptr)
+					{
+						results[index] = result;
+						successCount++;
+					}
+
+					index = nextIndex++;
+				}
+			};
+
+			std::vector<std::thread> workers;
+			workers.reserve(workerCount);
+
+			for (size_t index = 0; index < workerCount; index++)
+			{
+				workers.emplace_back(worker);
+			}
+
+			for (std::thread& thread : workers)
+			{
+				thread.join();
+			}
+		}
+
+		return successCount;
+	}
+
+	int GetRawAudioSignature(
+		const char* filePath,
+		uint32_t* buffer,
+		size_t bufferSize,
+		size_t* length,
+		int* algorithm)
+	{
+		SignatureSession session;
+
+		int status =
+			session.RunRaw(filePath, buffer, bufferSize, length, algorithm);
+
+		return status;
+	}
+
+	char* GetAudioSignatureInternal(
+		ChromaprintContext* context,
+		AudioReader& reader,
+		bool first,
+		double timestamp,
+		double duration,
+		spdlog::logger& log)
+	{
+		char* audioSignature = nullptr;
+		int size;
+
+		int result = chromaprint_get_raw_fingerprint_size(context, &size);
+
+		if (result == 0)
+		{
+			log.error("Could not get the fingerprinting size");
+		}
+		else
+		{
+			if (size <= 0 && first == true)
+			{
+				log.error("Empty fingerprint");
+			}
+			else
+			{
+				result = chromaprint_get_fingerprint(context, &audioSignature);
+
+				if (result == 0)
+				{
+					log.error("Could not get the fingerprinting");
+				}
+			}
+		}
+
+		return audioSignature;
+	}
+
+	size_t GetFirstPartSize(
+		size_t frameSize,
+		size_t chunkLimit,
+		size_t extraChunkLimit,
+		size_t chunkSize)
+	{
+		bool chunkDone = false;
+
+		size_t firstPartSize = frameSize;
+
+		if (chunkLimit > 0)
+		{
+			size_t remaining = chunkLimit + extraChunkLimit - chunkSize;
+
+			if (frameSize > remaining)
+			{
+				firstPartSize = remaining;
+			}
+		}
+
+		return firstPartSize;
+	}
+
+	size_t GetFrameSize(
+		size_t streamLimit, size_t streamSize, size_t frameSize)
+	{
+		if (streamLimit > 0)
+		{
+			const size_t remaining = streamLimit - streamSize;
+
+			if (frameSize > remaining)
+			{
+				frameSize = remaining;
+			}
+		}
+
+		return frameSize;
+	}
+
+	int GetInterruptionStatus(ReadInterruption interruption)
+	{
+		int status = SignatureFailed;
+
+		switch (interruption)
+		{
+			case ReadInterruption::Cancelled:
+				status = SignatureCancelled;
+				break;
+			case ReadInterruption::TimedOut:
+				status = SignatureTimedOut;
+				break;
+			case ReadInterruption::ReadLimit:
+				status = SignatureReadLimitExceeded;
+				break;
+			default:
+				break;
+		}
+
+		return status;
+	}
+
+	std::shared_ptr<spdlog::logger> GetLogger()
+	{
+		std::lock_guard<std::mutex> lock(loggerMutex);
+
+		if (sharedLogger == nullptr)
+		{
+			sharedLogger = MakeLogger(spdlog::level::info, nullptr);
+		}
+
+		return sharedLogger;
+	}
+
+	int GetRawAudioSignatureInternal(
+		ChromaprintContext* context,
+		bool first,
+		uint32_t* buffer,
+		size_t bufferSize,
+		size_t* length,
+		spdlog::logger& log)
+	{
+		int status = SignatureFailed;
+		uint32_t* fingerprint = nullptr;
+		int size = 0;
+
+		int result =
+			chromaprint_get_raw_fingerprint(context, &fingerprint, &size);
+
+		if (result == 0)
+		{
+			log.error("Could not get the raw fingerprint");
+		}
+		else if (size <= 0 && first == true)
+		{
+			log.error("Empty fingerprint");
+		}
+		else
+		{
+			*length = static_cast<size_t>(size);
+
+			if (*length > bufferSize)
+			{
+				status = SignatureBufferTooSmall;
+			}
+			else
+			{
+				std::copy(fingerprint, fingerprint + size, buffer);
+				status = SignatureSuccess;
+			}
+		}
+
+		chromaprint_dealloc(fingerprint);
+
+		return status;
+	}
+
+	size_t GetWorkerCount(int threadCount, size_t itemCount)
+	{
+		size_t workerCount = static_cast<size_t>(threadCount);
+
+		if (threadCount <= 0)
+		{
+			workerCount = std::thread::hardware_concurrency();
+
+			if (workerCount == 0)
+			{
+				workerCount = 1;
+			}
+		}
 
-namespace AudioSignature
-{
-	char* GetAudioSignatureInternal(
-		ChromaprintContext* context,
-		FFmpegAudioReader& reader,
-		bool first,
-		double timestamp,
-		double duration,
-		spdlog::logger);
-	size_t GetFirstPartSize(
-		size_t frameSize,
-		size_t chunkLimit,
-		size_t extraChunkLimit,
-		size_t chunkSize);
-	size_t GetFrameSize(
-		size_t streamLimit, size_t streamSize, size_t frameSize);
-	spdlog::logger GetLogger();
-	bool IsStreamDone(size_t streamLimit, size_t streamSize, size_t frameSize);
+		if (workerCount > itemCount)
+		{
+			workerCount = itemCount;
+		}
 
-	void FreeAudioSignature(char* data)
+		return workerCount;
+	}
+
+	void InitializeLogging(int level, const char* logPath)
 	{
-		if (data != nullptr)
+		spdlog::level::level_enum logLevel = spdlog::level::off;
+
+		if (level >= spdlog::level::trace && level < spdlog::level::off)
 		{
-			free(data);
+			logLevel = static_cast<spdlog::level::level_enum>(level);
 		}
+
+		std::lock_guard<std::mutex> lock(loggerMutex);
+
+		sharedLogger = MakeLogger(logLevel, logPath);
 	}
 
-	char* GetAudioSignature(const char* filePath)
+	bool IsValidOptions(const SignatureOptions* options)
 	{
-		char* result = nullptr;
+		bool valid = false;
 
-		spdlog::logger logger = GetLogger();
+		if (options != nullptr &&
+			options->maxDuration >= 0 &&
+			options->maxChunkDuration >= 0 &&
+			options->algorithm >= CHROMAPRINT_ALGORITHM_TEST1 &&
+			options->algorithm <= CHROMAPRINT_ALGORITHM_TEST5 &&
+			options->startOffset >= 0.0 &&
+			(options->inputMode == SignatureInputFile ||
+			options->inputMode == SignatureInputMemoryMapped) &&
+			(options->resampleMode == SignatureResampleCompatible ||
+			options->resampleMode == SignatureResampleFast) &&
+			options->decoderThreads >= 0 &&
+			options->timeout >= 0.0 &&
+			options->maxBytesRead >= 0)
+		{
+			valid = true;
+		}
 
-		if (filePath != nullptr && std::filesystem::exists(filePath))
+		return valid;
+	}
+
+	bool IsStreamDone(size_t streamLimit, size_t streamSize, size_t frameSize)
+	{
+		bool streamDone = false;
+
+		if (streamLimit > 0)
+		{
+			const size_t remaining = streamLimit - streamSize;
+
+			if (frameSize > remaining)
+			{
+				streamDone = true;
+			}
+		}
+
+		return streamDone;
+	}
+
+	std::shared_ptr<spdlog::logger> MakeLogger(
+		spdlog::level::level_enum level, const char* logPath)
+	{
+		std::shared_ptr<spdlog::logger> logger;
+
+		// When logging is off, the logger has no sinks, so the log file is
+		// never opened, and no background thread is started for it.
+		if (level == spdlog::level::off)
+		{
+			logger = std::make_shared<spdlog::logger>("log");
+		}
+		else
+		{
+			if (logPath == nullptr)
+			{
+				logPath = "MusicMan.log";
+			}
+
+			std::vector<spdlog::sink_ptr> sinks;
+
+			std::shared_ptr<spdlog::sinks::stdout_sink_mt> consoleLog =
+				std::make_shared<spdlog::sinks::stdout_sink_mt>();
+			sinks.push_back(consoleLog);
+
+			std::shared_ptr<spdlog::sinks::basic_file_sink_mt> fileLog =
+				std::make_shared<spdlog::sinks::basic_file_sink_mt>(logPath);
+			sinks.push_back(fileLog);
+
+			if (loggerThreadPool == nullptr)
+			{
+				loggerThreadPool =
+					std::make_shared<spdlog::details::thread_pool>(8192, 1);
+			}
+
+			logger = std::make_shared<spdlog::async_logger>(
+				"log",
+				begin(sinks),
+				end(sinks),
+				loggerThreadPool,
+				spdlog::async_overflow_policy::overrun_oldest);
+		}
+
+		logger->set_level(level);
+		logger->flush_on(spdlog::level::err);
+
+		return logger;
+	}
+
+	ReadBudget MakeReadBudget(const SignatureOptions& options)
+	{
+		ReadBudget budget;
+
+		if (options.cancellation != nullptr)
+		{
+			budget.cancelled = &options.cancellation->cancelled;
+		}
+
+		// The deadline runs from the start of each file, rather than the
+		// call, so that a file waiting in the queue behind others still
+		// gets the whole timeout.
+		if (options.timeout > 0.0)
 		{
-			FFmpegAudioReader reader;
+			std::chrono::duration<double> timeout(options.timeout);
+
+			budget.deadline = std::chrono::steady_clock::now() +
+				std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+		}
+
+		budget.maxBytesRead = options.maxBytesRead;
+
+		return budget;
+	}
+
+	int ProcessFile(
+		ChromaprintContext* context,
+		AudioReader& reader,
+		const char* filePath,
+		const SignatureOptions& options,
+		spdlog::logger& logger,
+		const FingerprintHandler& handler)
+	{
+		int status = SignatureFailed;
 
-			ChromaprintContext* context =
-				chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT);
+		if (filePath != nullptr && std::filesystem::exists(filePath))
+		{
+			StageTimes times;
+			double audioSeconds = 0.0;
 
-			// These are values that could be set from fpcalc command line,
-			// so just constants here, for the time being
-			double ts = 0.0;
-			const int maxDuration = 120;
-			const int maxChunkDuration = 0;
-			bool overlap = false;
+			double ts = options.startOffset;
+			const int maxDuration = options.maxDuration;
+			const int maxChunkDuration = options.maxChunkDuration;
+			bool overlap = options.overlap != 0;
 
 			int channels = chromaprint_get_num_channels(context);
 			int sampleRate = chromaprint_get_sample_rate(context);
 			reader.SetOutputChannels(channels);
 			reader.SetOutputSampleRate(sampleRate);
+			reader.SetMemoryMapped(
+				options.inputMode == SignatureInputMemoryMapped);
+			reader.SetFastResampling(
+				options.resampleMode == SignatureResampleFast);
+			reader.SetDecoderThreads(options.decoderThreads);
+			reader.SetBudget(MakeReadBudget(options));
+
+			bool opened;
 
-			if (!reader.Open(filePath))
+			{
+				StageTimer timer(times.open);
+				opened = reader.Open(filePath);
+			}
+
+			if (!opened)
 			{
 				std::string error = "ERROR: " + reader.GetError();
 				logger.error(error);
@@ -90,7 +1252,10 @@ namespace AudioSignature
 				{
 					size_t chunk_size = 0;
 					size_t stream_size = 0;
+					size_t skip_size = 0;
 
+					const size_t skip_limit = static_cast<size_t>(
+						options.startOffset * sampleRate);
 					const size_t stream_limit = maxDuration * sampleRate;
 					const size_t chunk_limit = maxChunkDuration * sampleRate;
 					size_t extra_chunk_limit = 0;
@@ -104,13 +1269,19 @@ namespace AudioSignature
 					}
 
 					bool first_chunk = true;
+					bool chunk_failed = false;
 					bool read_failed = false;
 
 					while (!reader.IsFinished())
 					{
 						const int16_t* frame_data = nullptr;
 						size_t frame_size = 0;
-						bool check = reader.Read(&frame_data, &frame_size);
+						bool check;
+
+						{
+							StageTimer timer(times.decode);
+							check = reader.Read(&frame_data, &frame_size);
+						}
 
 						if (check == false)
 						{
@@ -120,6 +1291,21 @@ namespace AudioSignature
 							break;
 						}
 
+						if (skip_size < skip_limit)
+						{
+							size_t skipped =
+								std::min(frame_size, skip_limit - skip_size);
+
+							skip_size += skipped;
+							frame_data += skipped * channels;
+							frame_size -= skipped;
+
+							if (frame_size == 0)
+							{
+								continue;
+							}
+						}
+
 						bool streamDone =
 							IsStreamDone(stream_limit, stream_size, frame_size);
 						frame_size =
@@ -145,8 +1331,13 @@ namespace AudioSignature
 							chunk_size);
 
 						auto sizing = first_part_size * channels;
-						int result =
-							chromaprint_feed(context, frame_data, sizing);
+						int result;
+
+						{
+							StageTimer timer(times.fingerprint);
+							result =
+								chromaprint_feed(context, frame_data, sizing);
+						}
 
 						if (result == 0)
 						{
@@ -155,14 +1346,79 @@ namespace AudioSignature
 						}
 
 						chunk_size += first_part_size;
+
+						if (chunk_limit > 0 &&
+							chunk_size >= chunk_limit + extra_chunk_limit)
+						{
+							int finished;
+
+							{
+								StageTimer timer(times.finish);
+								finished = chromaprint_finish(context);
+							}
+
+							if (!finished)
+							{
+								logger.error("Could not finish the audio signtature process");
+								chunk_failed = true;
+								break;
+							}
+
+							const auto chunk_duration =
+								(chunk_size - extra_chunk_limit) * 1.0 /
+								sampleRate + overlapAmount;
+
+							if (!handler(first_chunk, ts, chunk_duration))
+							{
+								chunk_failed = true;
+								break;
+							}
+
+							ts += chunk_duration;
+
+							// With overlap, the audio still buffered in the
+							// context carries over into the next chunk.
+							if (overlap)
+							{
+								checkResult =
+									chromaprint_clear_fingerprint(context);
+								ts -= overlapAmount;
+							}
+							else
+							{
+								checkResult = chromaprint_start(
+									context, sampleRate, channels);
+							}
+
+							if (checkResult == 0)
+							{
+								logger.error(
+									"Could not restart the audio signature process");
+								chunk_failed = true;
+								break;
+							}
+
+							if (first_chunk)
+							{
+								extra_chunk_limit = 0;
+								first_chunk = false;
+							}
+
+							chunk_size = 0;
+						}
+
 						frame_data += first_part_size * channels;
 						frame_size -= first_part_size;
 
 						if (frame_size > 0)
 						{
 							int length = frame_size * channels;
-							result =
-								chromaprint_feed(context, frame_data, length);
+
+							{
+								StageTimer timer(times.fingerprint);
+								result = chromaprint_feed(
+									context, frame_data, length);
+							}
 
 							if (result == 0)
 							{
@@ -179,7 +1435,32 @@ namespace AudioSignature
 						}
 					}
 
-					if (!chromaprint_finish(context))
+					audioSeconds =
+						static_cast<double>(skip_size + stream_size) /
+						sampleRate;
+
+					// A file stopped early is not fingerprinted from
+					// what was read, as that would be a different
+					// fingerprint from a full read.
+					bool interrupted =
+						reader.GetInterruption() != ReadInterruption::None;
+					int finished = 0;
+
+					if (chunk_failed == false && interrupted == false)
+					{
+						StageTimer timer(times.finish);
+						finished = chromaprint_finish(context);
+					}
+
+					if (interrupted == true)
+					{
+						logger.error("The file was stopped early");
+					}
+					else if (chunk_failed == true)
+					{
+						logger.error("Could not process the audio chunks");
+					}
+					else if (!finished)
 					{
 						logger.error("Could not finish the audio signtature process");
 					}
@@ -187,25 +1468,38 @@ namespace AudioSignature
 					{
 						const auto chunk_duration =
 							(chunk_size - extra_chunk_limit) * 1.0 /
-							sampleRate + overlap;
-
-						result = GetAudioSignatureInternal(
-							context,
-							reader,
-							first_chunk,
-							ts,
-							chunk_duration,
-							logger);
+							sampleRate + overlapAmount;
+
+						if (handler(first_chunk, ts, chunk_duration))
+						{
+							status = SignatureSuccess;
+						}
 					}
 					else if (first_chunk)
 					{
 						logger.error("Not enough audio data");
 					}
+					else
+					{
+						// The audio ended exactly on a chunk boundary
+						status = SignatureSuccess;
+					}
 				}
 			}
 
+			// Resampling happens within the reads, so is taken out of the
+			// decoding time.
+			times.resample = reader.GetResampleTime();
+			times.decode -= times.resample;
+
+			RecordStageTimes(reader.GetCodecName(), times, audioSeconds);
+
+			if (reader.GetInterruption() != ReadInterruption::None)
+			{
+				status = GetInterruptionStatus(reader.GetInterruption());
+			}
+
 			reader.Close();
-			chromaprint_free(context);
 		}
 		else
 		{
@@ -213,117 +1507,148 @@ namespace AudioSignature
 			logger.error(error);
 		}
 
-		return result;
+		return status;
 	}
 
-	char* GetAudioSignatureInternal(
-		ChromaprintContext* context,
-		FFmpegAudioReader& reader,
-		bool first,
-		double timestamp,
-		double duration,
-		spdlog::logger log)
+	double SignatureSessionGetDuration(SignatureSession* session)
 	{
-		char* audioSignature = nullptr;
-		int size;
-
-		int result = chromaprint_get_raw_fingerprint_size(context, &size);
+		double duration = 0.0;
 
-		if (result == 0)
+		if (session != nullptr)
 		{
-			log.error("Could not get the fingerprinting size");
+			duration = session->GetDuration();
 		}
-		else
-		{
-			if (size <= 0 && first == true)
-			{
-				log.error("Empty fingerprint");
-			}
-			else
-			{
-				result = chromaprint_get_fingerprint(context, &audioSignature);
 
-				if (result == 0)
-				{
-					log.error("Could not get the fingerprinting");
-				}
-			}
+		return duration;
+	}
+
+	int SignatureSessionGetStatus(SignatureSession* session)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (session != nullptr)
+		{
+			status = session->GetStatus();
 		}
 
-		return audioSignature;
+		return status;
 	}
 
-	size_t GetFirstPartSize(
-		size_t frameSize,
-		size_t chunkLimit,
-		size_t extraChunkLimit,
-		size_t chunkSize)
+	char* SignatureSessionRun(SignatureSession* session, const char* filePath)
 	{
-		bool chunkDone = false;
+		char* result = nullptr;
 
-		size_t firstPartSize = frameSize;
+		if (session != nullptr)
+		{
+			result = session->Run(filePath);
+		}
 
-		if (chunkLimit > 0)
+		return result;
+	}
+
+	int SignatureSessionRunChunks(
+		SignatureSession* session,
+		const char* filePath,
+		SignatureChunk** chunks,
+		size_t* count)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (session != nullptr)
 		{
-			size_t remaining = chunkLimit + extraChunkLimit - chunkSize;
+			status = session->RunChunks(filePath, chunks, count);
+		}
 
-			if (frameSize > remaining)
-			{
-				firstPartSize = remaining;
-			}
+		return status;
+	}
+
+	int SignatureSessionSetOptions(
+		SignatureSession* session, const SignatureOptions* options)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (session != nullptr)
+		{
+			status = session->SetOptions(options);
 		}
 
-		return firstPartSize;
+		return status;
 	}
 
-	size_t GetFrameSize(
-		size_t streamLimit, size_t streamSize, size_t frameSize)
+	int SignatureSessionRunRaw(
+		SignatureSession* session,
+		const char* filePath,
+		uint32_t* buffer,
+		size_t bufferSize,
+		size_t* length,
+		int* algorithm)
 	{
-		if (streamLimit > 0)
+		int status = SignatureInvalidArgument;
+
+		if (session != nullptr)
 		{
-			const size_t remaining = streamLimit - streamSize;
+			status = session->RunRaw(
+				filePath, buffer, bufferSize, length, algorithm);
+		}
 
-			if (frameSize > remaining)
-			{
-				frameSize = remaining;
-			}
+		return status;
+	}
+
+	int SignatureSessionRunToBuffer(
+		SignatureSession* session,
+		const char* filePath,
+		char* buffer,
+		size_t bufferSize,
+		size_t* length)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (session != nullptr)
+		{
+			status =
+				session->RunToBuffer(filePath, buffer, bufferSize, length);
 		}
 
-		return frameSize;
+		return status;
 	}
 
-	spdlog::logger GetLogger()
+	SignatureStream* SignatureStreamBegin(int sampleRate, int channels)
 	{
-		std::vector<spdlog::sink_ptr> sinks;
+		SignatureStream* stream = new SignatureStream();
+
+		if (!stream->Begin(sampleRate, channels))
+		{
+			delete stream;
+			stream = nullptr;
+		}
 
-		std::shared_ptr<spdlog::sinks::stdout_sink_st> consoleLog =
-			std::make_shared<spdlog::sinks::stdout_sink_st>();
-		sinks.push_back(consoleLog);
+		return stream;
+	}
 
-		std::shared_ptr<spdlog::sinks::basic_file_sink_st> fileLog =
-			std::make_shared<spdlog::sinks::basic_file_sink_st>("MusicMan.log");
-		sinks.push_back(fileLog);
+	int SignatureStreamFeed(
+		SignatureStream* stream, const int16_t* data, size_t size)
+	{
+		int status = SignatureInvalidArgument;
 
-		spdlog::logger logger =
-			spdlog::logger("log", begin(sinks), end(sinks));
+		if (stream != nullptr)
+		{
+			status = stream->Feed(data, size);
+		}
 
-		return logger;
+		return status;
 	}
 
-	bool IsStreamDone(size_t streamLimit, size_t streamSize, size_t frameSize)
+	char* SignatureStreamFinish(SignatureStream* stream)
 	{
-		bool streamDone = false;
+		char* result = nullptr;
 
-		if (streamLimit > 0)
+		if (stream != nullptr)
 		{
-			const size_t remaining = streamLimit - streamSize;
+			result = stream->Finish();
 
-			if (frameSize > remaining)
-			{
-				streamDone = true;
-			}
+			delete stream;
 		}
 
-		return streamDone;
+		return result;
 	}
 }
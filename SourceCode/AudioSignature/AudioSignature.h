@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 namespace AudioSignature
 {
 	#if defined _WIN32 || defined __CYGWIN__
@@ -42,6 +45,530 @@ namespace AudioSignature
 		#endif
 	#endif
 
+	class FingerprintIndex;
+	class SignatureCancellation;
+	class SignatureSession;
+	class SignatureStream;
+
+	// Receives the result of an asynchronous call, on a library thread,
+	// with its SignatureStatus.  The signature, or nullptr on failure,
+	// belongs to the callback, and must be freed with FreeAudioSignature.
+	typedef void (*SignatureCallback)(
+		int status, char* audioSignature, void* userData);
+
+	enum SignatureStatus
+	{
+		SignatureSuccess = 0,
+		SignatureFailed = 1,
+		SignatureInvalidArgument = 2,
+		SignatureBufferTooSmall = 3,
+
+		// The file took longer than options.timeout.
+		SignatureTimedOut = 4,
+
+		// The options' cancellation was signalled.
+		SignatureCancelled = 5,
+
+		// The file read more than options.maxBytesRead.
+		SignatureReadLimitExceeded = 6
+	};
+
+	enum AudioFormatDifference
+	{
+		AudioFormatSame = 0,
+		AudioFormatSampleRate = 1,
+		AudioFormatChannels = 2,
+		AudioFormatSampleFormat = 4,
+		AudioFormatBitsPerSample = 8
+	};
+
+	enum AudioAnalysisType
+	{
+		// The fingerprint, as GetAudioSignatureWithOptions gives.
+		AudioAnalysisSignature = 1,
+
+		// The hash of the decoded samples, as GetAudioContentHash gives
+		// without normalizing.
+		AudioAnalysisContentHash = 2,
+
+		// The EBU R128 integrated loudness and the sample peak.
+		AudioAnalysisLoudness = 4,
+
+		// The codec, format, bit rate and decoded duration.
+		AudioAnalysisProperties = 8,
+
+		AudioAnalysisAll = 15
+	};
+
+	enum SignatureInputMode
+	{
+		// Read through FFmpeg's own file protocol.
+		SignatureInputFile = 0,
+
+		// Memory map the file and serve it through a custom I/O context.
+		SignatureInputMemoryMapped = 1
+	};
+
+	enum SignatureResampleMode
+	{
+		// Convert with swresample, set up as fpcalc does, so that the
+		// fingerprints match fpcalc's exactly.
+		SignatureResampleCompatible = 0,
+
+		// Convert 44.1 and 48 kHz mono and stereo audio with a dedicated
+		// vector filter, falling back to swresample for anything else.
+		// The fingerprints are close to, but not always the same as, the
+		// compatible ones.
+		SignatureResampleFast = 1
+	};
+
+	struct SignatureOptions
+	{
+		// The maximum number of seconds of audio to process, or zero for
+		// the whole file.
+		int maxDuration;
+
+		// The length of each chunk in seconds, or zero for none.  Only
+		// used by the chunk calls.
+		int maxChunkDuration;
+
+		// Non-zero to overlap the chunks by the fingerprint delay.  Only
+		// used by the chunk calls.
+		int overlap;
+
+		// The chromaprint algorithm, CHROMAPRINT_ALGORITHM_TEST1 to TEST5.
+		int algorithm;
+
+		// The number of seconds of audio to skip before processing.
+		double startOffset;
+
+		// How the file is read, one of the SignatureInputMode values.
+		int inputMode;
+
+		// How the audio is converted for chromaprint, one of the
+		// SignatureResampleMode values.
+		int resampleMode;
+
+		// The threads each file's decoder may use, for codecs that support
+		// frame or slice threading.  One decodes on the calling thread
+		// alone, and zero lets FFmpeg pick from the processor count.
+		int decoderThreads;
+
+		// The most seconds to spend on each file, or zero for no limit.
+		double timeout;
+
+		// The most bytes to read from each file, or zero for no limit.
+		int64_t maxBytesRead;
+
+		// Stops the call when cancelled, or nullptr for none.
+		SignatureCancellation* cancellation;
+	};
+
+	struct SignatureChunk
+	{
+		// The start of the chunk, in seconds from the start of the file.
+		double timestamp;
+
+		// The length of the chunk in seconds.
+		double duration;
+
+		char* audioSignature;
+	};
+
+	struct AudioContentComparison
+	{
+		// Non-zero if the decoded audio of the two files is the same.
+		int identical;
+
+		// The first sample frame at which the audio differs, which is
+		// the length of the shorter file if one is a prefix of the
+		// other, or -1 if identical.
+		int64_t mismatchOffset;
+
+		// A combination of AudioFormatDifference flags.
+		int formatDifferences;
+	};
+
+	// The results of AnalyzeAudioFile.  Only the parts of the analyses
+	// that completed are set.
+	struct AudioAnalysis
+	{
+		// A combination of the AudioAnalysisType flags of the analyses
+		// that completed.
+		int completed;
+
+		// Freed by FreeAudioAnalysis.
+		char* audioSignature;
+
+		// The SHA-256 of the decoded samples, in lower case hex.
+		char contentHash[65];
+
+		// The FFmpeg name of the codec.
+		char codec[32];
+
+		int sampleRate;
+		int channels;
+		int bitsPerSample;
+
+		// In bits per second, or zero if the file does not record it.
+		int64_t bitRate;
+
+		// The seconds of audio decoded.
+		double duration;
+
+		// In LUFS, or negative infinity for silence.
+		double integratedLoudness;
+
+		// The largest absolute sample, at full scale of one.
+		double samplePeak;
+	};
+
+	// The format of a file, as ProbeAudioFile reads it from the headers.
+	struct AudioProbe
+	{
+		// The FFmpeg AVCodecID of the audio stream.
+		int codecId;
+
+		// The FFmpeg name of the codec.
+		char codec[32];
+
+		// Non-zero if the codec is lossless only.  Codecs that can be
+		// either, such as DTS, count as lossy.
+		int lossless;
+
+		int sampleRate;
+
+		// The source bit depth, where the headers record it, or zero.
+		int bitsPerSample;
+		int channels;
+
+		// In seconds, from the headers, or estimated from the size and
+		// bit rate where they do not say.
+		double duration;
+
+		// In bits per second, or zero if unknown.
+		int64_t bitRate;
+	};
+
+	// The time spent in each stage of fingerprinting, totalled over all
+	// files of one codec.
+	struct SignatureStats
+	{
+		// The FFmpeg name of the codec.
+		char codec[32];
+
+		uint64_t files;
+
+		// The seconds of audio decoded.
+		double audioSeconds;
+
+		// Opening the file, probing the streams and opening the decoder.
+		double openSeconds;
+
+		// Reading and decoding packets, less the resampling.
+		double decodeSeconds;
+
+		// Converting to the rate and channels chromaprint takes.
+		double resampleSeconds;
+
+		// Chromaprint's own processing of the samples, the FFT and
+		// chroma features.
+		double fingerprintSeconds;
+
+		// Chromaprint's classification and encoding of the fingerprint.
+		double finishSeconds;
+	};
+
+	struct FingerprintMatch
+	{
+		uint32_t trackId = 0;
+
+		// The number of sub-fingerprints matching at the best alignment.
+		uint32_t matches = 0;
+
+		// The position in the track's fingerprint of the start of the
+		// query, at the best alignment.
+		int32_t offset = 0;
+	};
+
+	struct TranscodeOptions
+	{
+		// The FFmpeg name of the encoder, such as flac, alac, aac or
+		// libmp3lame.  The container comes from each output path's
+		// extension.
+		const char* encoder;
+
+		// In bits per second, for the lossy encoders, or zero for the
+		// encoder's default.
+		int64_t bitRate;
+
+		// The encoder's compression level, such as 0 to 12 for FLAC, or
+		// -1 for the encoder's default.
+		int compressionLevel;
+
+		// The files to transcode at once, or zero for the processor
+		// count.
+		int threadCount;
+
+		// Non-zero to replace existing output files, rather than fail
+		// them.
+		int overwrite;
+
+		// Stops the files not yet finished when cancelled, or nullptr for
+		// none.
+		SignatureCancellation* cancellation;
+	};
+
+	// Decodes the file once, handing the audio to each of the analyses
+	// asked for, a combination of AudioAnalysisType flags, rather than
+	// decoding it again for each.  The options apply to the reading and
+	// the fingerprint, with null for the defaults.  Returns
+	// SignatureSuccess if the file was read through, with the analyses
+	// that completed flagged in analysis->completed.  The analysis must be
+	// freed with FreeAudioAnalysis.
+	LIB_API(int) AnalyzeAudioFile(
+		const char* filePath,
+		const SignatureOptions* options,
+		int analyses,
+		AudioAnalysis* analysis);
+	LIB_API(void) FreeAudioAnalysis(AudioAnalysis* analysis);
+
+	// Compares two raw fingerprints, trying every alignment of up to
+	// maxOffset items either way, and returns the lowest bit error rate
+	// found, from 0 for identical to about 0.5 for unrelated audio, with
+	// the offset of the second fingerprint into the first that gave it.
+	// Only alignments covering at least half of the shorter fingerprint
+	// are considered.
+	LIB_API(int) CompareAudioSignatures(
+		const uint32_t* first,
+		size_t firstLength,
+		const uint32_t* second,
+		size_t secondLength,
+		int maxOffset,
+		double* bitErrorRate,
+		int* bestOffset);
+
+	// Decodes two files in lockstep, comparing their samples, and stops at
+	// the first difference.  Files differing in sample rate, channels or
+	// sample format are reported as such without decoding.
+	LIB_API(int) CompareAudioContent(
+		const char* firstPath,
+		const char* secondPath,
+		AudioContentComparison* comparison);
+
+	// Returns the SHA-256, in hex, of the decoded audio, to be freed with
+	// FreeAudioSignature.  Without normalize, the samples keep the
+	// decoder's own rate, channels and precision, so files are equal only
+	// if their audio is bit for bit the same.  With normalize, the audio
+	// is converted to 44.1 kHz, 16 bit stereo first.
+	LIB_API(char*) GetAudioContentHash(const char* filePath, bool normalize);
 	LIB_API(char*) GetAudioSignature(const char* filePath);
+
+	// Queues the file on the library's own pool of threads, one per
+	// processor, and returns at once, so that any number of calls can be
+	// outstanding without blocking the caller's threads.  The callback is
+	// called, with userData, once the signature is taken.  Null options
+	// use the defaults.  Returns SignatureSuccess if queued, in which case
+	// the callback is always called.
+	LIB_API(int) GetAudioSignatureAsync(
+		const char* filePath,
+		const SignatureOptions* options,
+		SignatureCallback callback,
+		void* userData);
+
+	// As GetAudioSignatures, but all of the results are returned in a
+	// single block, the array of pointers followed by the signatures,
+	// freed at once with FreeAudioSignatureBatch.  Files that could not be
+	// processed have a null entry.  Returns the number of files
+	// successfully fingerprinted.
+	LIB_API(int) GetAudioSignatureBatch(
+		const char** filePaths,
+		size_t count,
+		int threadCount,
+		char*** results);
+	LIB_API(void) FreeAudioSignatureBatch(char** results);
+
+	// Writes the signature, with its terminating null, into the caller's
+	// buffer, so that nothing needs freeing afterwards, and sets length
+	// to the signature's length, not counting the null.  If the buffer is
+	// too small, SignatureBufferTooSmall is returned, with length still
+	// set, so the buffer needs to be at least length + 1.  Null options
+	// use the defaults.
+	LIB_API(int) GetAudioSignatureToBuffer(
+		const char* filePath,
+		const SignatureOptions* options,
+		char* buffer,
+		size_t bufferSize,
+		size_t* length);
+	LIB_API(char*) GetAudioSignatureWithOptions(
+		const char* filePath, const SignatureOptions* options);
+
+	// Fingerprints the list of files on a pool of worker threads, writing
+	// each signature into the matching slot of results, or nullptr on
+	// failure.  A threadCount of zero or less uses the processor count.
+	// With fewer files than processors, and no threadCount given, the
+	// spare processors are shared out to the decoders.
+	// Each result must be freed with FreeAudioSignature.  Returns the
+	// number of files successfully fingerprinted.
+	LIB_API(int) GetAudioSignatures(
+		const char** filePaths,
+		size_t count,
+		char** results,
+		int threadCount);
+
 	LIB_API(void) FreeAudioSignature(char* data);
+
+	// Fingerprints the file in chunks of options->maxChunkDuration
+	// seconds, in a single decoding pass, returning one signature per
+	// chunk.  Set options->maxDuration to zero to cover the whole file.
+	// The chunks must be freed with FreeAudioSignatureChunks.
+	LIB_API(int) GetAudioSignatureChunks(
+		const char* filePath,
+		const SignatureOptions* options,
+		SignatureChunk** chunks,
+		size_t* count);
+	LIB_API(void) FreeAudioSignatureChunks(
+		SignatureChunk* chunks, size_t count);
+
+	// Fills in the default options, which match fpcalc.
+	LIB_API(void) GetDefaultSignatureOptions(SignatureOptions* options);
+
+	// Writes the raw, uncompressed fingerprint into the caller's buffer,
+	// along with its length in 32 bit items and the chromaprint algorithm
+	// used.  If the buffer is too small, SignatureBufferTooSmall is
+	// returned with length set to the size needed, so passing a null
+	// buffer and a size of zero queries the length.
+	LIB_API(int) GetRawAudioSignature(
+		const char* filePath,
+		uint32_t* buffer,
+		size_t bufferSize,
+		size_t* length,
+		int* algorithm);
+
+	// Replaces the shared logger.  The level follows spdlog, from 0 for
+	// trace to 5 for critical, and any other value turns logging off.  A
+	// null logPath uses MusicMan.log in the current directory.
+	LIB_API(void) InitializeLogging(int level, const char* logPath);
+
+	// Reads the format of the file's audio from its container headers,
+	// without decoding.  Only where the headers leave the format
+	// incomplete, as with MP3 and raw AAC, are the first few packets
+	// parsed, and then only half a second of them.
+	LIB_API(int) ProbeAudioFile(const char* filePath, AudioProbe* probe);
+
+	// Converts each input file to the matching output path on a pool of
+	// worker threads, decoding and encoding in process, with the tags and
+	// any cover art carried across.  Each file's SignatureStatus is
+	// written into the matching slot of statuses.  Output is written
+	// beside the final path and renamed into place once complete, so a
+	// file that fails leaves nothing behind.  Files given the same output
+	// as another are not transcoded, and are SignatureInvalidArgument.
+	// Null options use the defaults.  Returns the number of files
+	// successfully transcoded.
+	LIB_API(int) TranscodeAudioFiles(
+		const char** inputPaths,
+		const char** outputPaths,
+		size_t count,
+		const TranscodeOptions* options,
+		int* statuses);
+
+	// Fills in the default options, lossless FLAC at the encoder's
+	// default compression.
+	LIB_API(void) GetDefaultTranscodeOptions(TranscodeOptions* options);
+
+	// A cancellation stops the calls given it in their options, as soon
+	// as the reads notice, with SignatureCancelled.  It can be cancelled
+	// from any thread, but must outlive the calls using it.
+	LIB_API(SignatureCancellation*) CreateSignatureCancellation();
+	LIB_API(void) CancelSignature(SignatureCancellation* cancellation);
+	LIB_API(void) DestroySignatureCancellation(
+		SignatureCancellation* cancellation);
+
+	// A session keeps the fingerprinting context and decoder state alive
+	// across files.  A session must only be used by one thread at a time.
+	// SignatureSessionGetStatus gives the status of the last run, such as
+	// why SignatureSessionRun returned nullptr.
+	// SignatureSessionGetDuration gives the length in seconds of the last
+	// file run, from its container's headers rather than what was
+	// fingerprinted, or zero if unknown, or if the signature came from
+	// the cache.
+	LIB_API(SignatureSession*) CreateSignatureSession();
+	LIB_API(double) SignatureSessionGetDuration(SignatureSession* session);
+	LIB_API(int) SignatureSessionGetStatus(SignatureSession* session);
+	LIB_API(char*) SignatureSessionRun(
+		SignatureSession* session, const char* filePath);
+	LIB_API(int) SignatureSessionRunRaw(
+		SignatureSession* session,
+		const char* filePath,
+		uint32_t* buffer,
+		size_t bufferSize,
+		size_t* length,
+		int* algorithm);
+	LIB_API(int) SignatureSessionRunChunks(
+		SignatureSession* session,
+		const char* filePath,
+		SignatureChunk** chunks,
+		size_t* count);
+	LIB_API(int) SignatureSessionRunToBuffer(
+		SignatureSession* session,
+		const char* filePath,
+		char* buffer,
+		size_t bufferSize,
+		size_t* length);
+	LIB_API(int) SignatureSessionSetOptions(
+		SignatureSession* session, const SignatureOptions* options);
+	LIB_API(void) DestroySignatureSession(SignatureSession* session);
+
+	// A stream fingerprints audio already decoded by the caller, fed in as
+	// interleaved 16 bit samples, with size counting the samples of all
+	// channels.  SignatureStreamFinish returns the signature, to be freed
+	// with FreeAudioSignature, and always releases the stream.
+	LIB_API(SignatureStream*) SignatureStreamBegin(
+		int sampleRate, int channels);
+	LIB_API(int) SignatureStreamFeed(
+		SignatureStream* stream, const int16_t* data, size_t size);
+	LIB_API(char*) SignatureStreamFinish(SignatureStream* stream);
+
+	// A fingerprint index finds the tracks sharing sub-fingerprints with
+	// a query, for finding duplicate candidates across a library.  Keys
+	// are the top keyBits bits of each raw fingerprint item, where fewer
+	// bits tolerate more noise at the cost of more chance matches; 32
+	// keeps the whole item.  Adding a track id already in the index
+	// replaces its fingerprint, and Remove returns SignatureFailed for a
+	// track id not in it.  Search writes the tracks with at least
+	// minimumMatches aligned items, best first, with ties in order of
+	// track id, up to matchesSize.
+	LIB_API(FingerprintIndex*) CreateFingerprintIndex(int keyBits);
+	LIB_API(int) FingerprintIndexAdd(
+		FingerprintIndex* index,
+		uint32_t trackId,
+		const uint32_t* fingerprint,
+		size_t length);
+	LIB_API(int) FingerprintIndexRemove(
+		FingerprintIndex* index, uint32_t trackId);
+	LIB_API(int) FingerprintIndexSearch(
+		FingerprintIndex* index,
+		const uint32_t* fingerprint,
+		size_t length,
+		uint32_t minimumMatches,
+		FingerprintMatch* matches,
+		size_t matchesSize,
+		size_t* count);
+	LIB_API(void) DestroyFingerprintIndex(FingerprintIndex* index);
+
+	// A signature cache keeps the text signatures of files between runs,
+	// keyed by canonical path, size, modification time and options, so
+	// that only new or changed files are decoded again.  While open, it
+	// is checked by every single signature call; chunked and raw calls
+	// always decode.  Closing, or opening another, saves the new entries.
+	LIB_API(int) OpenSignatureCache(const char* cachePath);
+	LIB_API(int) CloseSignatureCache();
+
+	// The stage times of every file fingerprinted since the library was
+	// loaded, or last reset, one entry per codec.  If statsSize is too
+	// small, SignatureBufferTooSmall is returned with count set to the
+	// size needed.
+	LIB_API(int) GetAudioSignatureStats(
+		SignatureStats* stats, size_t statsSize, size_t* count);
+	LIB_API(void) ResetAudioSignatureStats();
 }
@@ -0,0 +1,960 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <cwctype>
+#endif
+
+#include "AudioTranscoder.h"
+#include "SignatureInternal.h"
+
+namespace AudioSignature
+{
+	// The samples per frame for encoders that take any number, a common
+	// decoder block size.
+	const int DefaultFrameSize = 4096;
+
+	// Tags describing the source container, rather than the music, which
+	// are left behind.
+	const char* const ContainerTags[] =
+	{
+		"compatible_brands",
+		"encoder",
+		"handler_name",
+		"major_brand",
+		"minor_version",
+		"vendor_id"
+	};
+
+	void CopyTags(
+		AVDictionary** tags,
+		const AVFormatContext* formatContext,
+		const AVStream* stream);
+	bool HasCoverArt(const AVOutputFormat* format);
+	bool IsValidTranscodeOptions(const TranscodeOptions& options);
+	void PickChannelLayout(
+		const AVCodec* codec,
+		const AVChannelLayout& source,
+		AVChannelLayout* layout);
+	AVSampleFormat PickSampleFormat(
+		const AVCodec* codec, AVSampleFormat format);
+	int PickSampleRate(const AVCodec* codec, int sampleRate);
+	void RejectDuplicateOutputs(
+		const char** outputPaths, size_t count, int* statuses);
+
+	AudioTranscoder::AudioTranscoder(const TranscodeOptions& options)
+		: options(options)
+	{
+		static std::atomic<unsigned int> transcoderCount = 0;
+
+		partialSuffix =
+			"." + std::to_string(transcoderCount++) + ".partial";
+
+		// The decoder's own samples, only packed, so that nothing is lost
+		// before the one conversion to the encoder's format.  Each decoder
+		// keeps to its worker's thread, as the files are the parallelism.
+		SignatureOptions readOptions;
+		GetDefaultSignatureOptions(&readOptions);
+		readOptions.cancellation = options.cancellation;
+
+		reader.SetOutputSampleFormat(AV_SAMPLE_FMT_NONE);
+		reader.SetBudget(MakeReadBudget(readOptions));
+	}
+
+	AudioTranscoder::~AudioTranscoder()
+	{
+		Close();
+	}
+
+	bool AudioTranscoder::AddCoverArt()
+	{
+		bool added = true;
+
+		const AVFormatContext* input = reader.GetFormatContext();
+
+		if (HasCoverArt(formatContext->oformat))
+		{
+			for (unsigned int index = 0;
+				index < input->nb_streams && added == true;
+				index++)
+			{
+				const AVStream* source = input->streams[index];
+
+				// The demuxers read the pictures with the headers, so they
+				// are there even though the reader discards the stream.
+				if ((source->disposition & AV_DISPOSITION_ATTACHED_PIC) &&
+					source->attached_pic.size > 0)
+				{
+					AVStream* picture =
+						avformat_new_stream(formatContext, nullptr);
+
+					if (picture == nullptr ||
+						avcodec_parameters_copy(
+							picture->codecpar, source->codecpar) < 0)
+					{
+						SetError("Could not add the cover art");
+						added = false;
+					}
+					else
+					{
+						picture->codecpar->codec_tag = 0;
+						picture->disposition = source->disposition;
+						picture->time_base = source->time_base;
+						av_dict_copy(&picture->metadata, source->metadata, 0);
+
+						coverArt.emplace_back(source, picture);
+					}
+				}
+			}
+		}
+
+		return added;
+	}
+
+	void AudioTranscoder::Close()
+	{
+		if (formatContext != nullptr &&
+			!(formatContext->oformat->flags & AVFMT_NOFILE))
+		{
+			avio_closep(&formatContext->pb);
+		}
+
+		avformat_free_context(formatContext);
+		formatContext = nullptr;
+
+		if (fifo != nullptr)
+		{
+			av_audio_fifo_free(fifo);
+			fifo = nullptr;
+		}
+
+		avcodec_free_context(&codecContext);
+		swr_free(&converter);
+		av_packet_free(&packet);
+		av_frame_free(&frame);
+
+		stream = nullptr;
+		coverArt.clear();
+		frameSize = 0;
+		nextPts = 0;
+
+		reader.Close();
+	}
+
+	std::string AudioTranscoder::GetError() const
+	{
+		return error;
+	}
+
+	bool AudioTranscoder::OpenConverter()
+	{
+		AVChannelLayout layout{};
+		reader.GetChannelLayout(&layout);
+
+		int result = swr_alloc_set_opts2(
+			&converter,
+			&codecContext->ch_layout,
+			codecContext->sample_fmt,
+			codecContext->sample_rate,
+			&layout,
+			reader.GetSampleFormat(),
+			reader.GetSampleRate(),
+			0,
+			nullptr);
+
+		av_channel_layout_uninit(&layout);
+
+		if (result >= 0)
+		{
+			result = swr_init(converter);
+		}
+
+		if (result < 0)
+		{
+			SetError("Could not set up the sample conversion", result);
+			return false;
+		}
+
+		frameSize = codecContext->frame_size;
+
+		if (frameSize <= 0)
+		{
+			frameSize = DefaultFrameSize;
+		}
+
+		int channels = codecContext->ch_layout.nb_channels;
+
+		fifo =
+			av_audio_fifo_alloc(codecContext->sample_fmt, channels, frameSize);
+		frame = av_frame_alloc();
+		packet = av_packet_alloc();
+
+		if (fifo == nullptr || frame == nullptr || packet == nullptr)
+		{
+			SetError("Could not allocate the encoding buffers");
+			return false;
+		}
+
+		frame->format = codecContext->sample_fmt;
+		frame->sample_rate = codecContext->sample_rate;
+		frame->nb_samples = frameSize;
+		av_channel_layout_copy(&frame->ch_layout, &codecContext->ch_layout);
+
+		result = av_frame_get_buffer(frame, 0);
+
+		if (result < 0)
+		{
+			SetError("Could not allocate the frame", result);
+			return false;
+		}
+
+		planes.resize(channels);
+
+		return true;
+	}
+
+	bool AudioTranscoder::OpenEncoder(const std::string& outputPath)
+	{
+		int result = avformat_alloc_output_context2(
+			&formatContext, nullptr, nullptr, outputPath.c_str());
+
+		if (result < 0)
+		{
+			SetError("Could not find a container for the output", result);
+			return false;
+		}
+
+		const AVCodec* codec = avcodec_find_encoder_by_name(options.encoder);
+
+		if (codec == nullptr || codec->type != AVMEDIA_TYPE_AUDIO)
+		{
+			SetError("Could not find the " + std::string(options.encoder) +
+				" encoder");
+			return false;
+		}
+
+		// Zero means the container cannot hold the codec, while those
+		// without a list of codecs give a negative result, and are left
+		// to the muxer to refuse.
+		if (avformat_query_codec(
+			formatContext->oformat, codec->id, FF_COMPLIANCE_NORMAL) == 0)
+		{
+			SetError("The output container cannot hold " +
+				std::string(codec->name));
+			return false;
+		}
+
+		codecContext = avcodec_alloc_context3(codec);
+
+		if (codecContext == nullptr)
+		{
+			SetError("Could not allocate the encoder");
+			return false;
+		}
+
+		AVChannelLayout layout{};
+		reader.GetChannelLayout(&layout);
+		PickChannelLayout(codec, layout, &codecContext->ch_layout);
+		av_channel_layout_uninit(&layout);
+
+		AVSampleFormat format = reader.GetSampleFormat();
+
+		codecContext->sample_fmt = PickSampleFormat(codec, format);
+		codecContext->sample_rate =
+			PickSampleRate(codec, reader.GetSampleRate());
+		codecContext->time_base = AVRational{ 1, codecContext->sample_rate };
+		codecContext->thread_count = 1;
+
+		// The source's bit depth, where narrower than its samples, such as
+		// 24 bit audio carried in 32, so that the lossless encoders keep
+		// it rather than padding it out.
+		int bits = reader.GetBitsPerSample();
+
+		if (av_get_packed_sample_fmt(codecContext->sample_fmt) == format &&
+			bits < av_get_bytes_per_sample(format) * 8)
+		{
+			codecContext->bits_per_raw_sample = bits;
+		}
+
+		if (options.bitRate > 0)
+		{
+			codecContext->bit_rate = options.bitRate;
+		}
+
+		if (options.compressionLevel >= 0)
+		{
+			codecContext->compression_level = options.compressionLevel;
+		}
+
+		if (formatContext->oformat->flags & AVFMT_GLOBALHEADER)
+		{
+			codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+		}
+
+		result = avcodec_open2(codecContext, codec, nullptr);
+
+		if (result < 0)
+		{
+			SetError("Could not open the " + std::string(codec->name) +
+				" encoder", result);
+			return false;
+		}
+
+		stream = avformat_new_stream(formatContext, nullptr);
+
+		if (stream == nullptr)
+		{
+			SetError("Could not add the audio stream");
+			return false;
+		}
+
+		stream->time_base = codecContext->time_base;
+
+		result =
+			avcodec_parameters_from_context(stream->codecpar, codecContext);
+
+		if (result < 0)
+		{
+			SetError("Could not set up the audio stream", result);
+			return false;
+		}
+
+		CopyTags(
+			&formatContext->metadata,
+			reader.GetFormatContext(),
+			reader.GetStream());
+
+		return true;
+	}
+
+	bool AudioTranscoder::OpenOutput(const std::string& temporaryPath)
+	{
+		int result = 0;
+
+		if (!(formatContext->oformat->flags & AVFMT_NOFILE))
+		{
+			result = avio_open(
+				&formatContext->pb, temporaryPath.c_str(), AVIO_FLAG_WRITE);
+
+			if (result < 0)
+			{
+				SetError("Could not create the output file", result);
+				return false;
+			}
+		}
+
+		result = avformat_write_header(formatContext, nullptr);
+
+		if (result < 0)
+		{
+			SetError("Could not write the output header", result);
+			return false;
+		}
+
+		return true;
+	}
+
+	int AudioTranscoder::Run(
+		const std::string& inputPath, const std::string& outputPath)
+	{
+		int status = SignatureFailed;
+
+		error.clear();
+
+		std::error_code ignored;
+
+		if (std::filesystem::equivalent(inputPath, outputPath, ignored))
+		{
+			SetError("The output would replace the input");
+		}
+		else if (options.overwrite == 0 &&
+			std::filesystem::exists(outputPath, ignored))
+		{
+			SetError("The output file already exists");
+		}
+		else
+		{
+			// Written beside the output, so that a file that fails never
+			// leaves a partial output, nor replaces an existing one.
+			std::string temporaryPath = outputPath + partialSuffix;
+
+			bool transcoded =
+				Transcode(inputPath, outputPath, temporaryPath);
+
+			ReadInterruption interruption = reader.GetInterruption();
+
+			Close();
+
+			if (transcoded == true)
+			{
+				std::error_code renameError;
+				std::filesystem::rename(
+					temporaryPath, outputPath, renameError);
+
+				if (renameError)
+				{
+					SetError("Could not move the output into place: " +
+						renameError.message());
+				}
+				else
+				{
+					status = SignatureSuccess;
+				}
+			}
+			else if (interruption != ReadInterruption::None)
+			{
+				status = GetInterruptionStatus(interruption);
+			}
+
+			if (status != SignatureSuccess)
+			{
+				std::filesystem::remove(temporaryPath, ignored);
+			}
+		}
+
+		return status;
+	}
+
+	void AudioTranscoder::SetError(const std::string& message, int errorCode)
+	{
+		error = message;
+
+		if (errorCode < 0)
+		{
+			char buffer[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+			av_strerror(errorCode, buffer, sizeof(buffer));
+
+			error += " (";
+			error += buffer;
+			error += ")";
+		}
+	}
+
+	bool AudioTranscoder::Transcode(
+		const std::string& inputPath,
+		const std::string& outputPath,
+		const std::string& temporaryPath)
+	{
+		if (!reader.Open(inputPath))
+		{
+			error = reader.GetError();
+			return false;
+		}
+
+		// The pictures are streams of their own, so they are added before
+		// the header is written, and their one packet each straight after.
+		if (!OpenEncoder(outputPath) ||
+			!AddCoverArt() ||
+			!OpenConverter() ||
+			!OpenOutput(temporaryPath) ||
+			!WriteCoverArt())
+		{
+			return false;
+		}
+
+		size_t sampleSize = static_cast<size_t>(reader.GetChannels()) *
+			av_get_bytes_per_sample(reader.GetSampleFormat());
+
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+		while (reader.ReadBytes(&data, &size))
+		{
+			if (!WriteAudio(data, size / sampleSize))
+			{
+				return false;
+			}
+		}
+
+		if (!reader.IsFinished())
+		{
+			error = reader.GetError();
+			return false;
+		}
+
+		// No data flushes the converter, the FIFO and then the encoder.
+		if (!WriteAudio(nullptr, 0))
+		{
+			return false;
+		}
+
+		int result = av_write_trailer(formatContext);
+
+		if (result < 0)
+		{
+			SetError("Could not finish the output file", result);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool AudioTranscoder::WriteAudio(const uint8_t* data, size_t frames)
+	{
+		bool flushing = data == nullptr;
+		int inputSize = static_cast<int>(frames);
+		int channels = codecContext->ch_layout.nb_channels;
+
+		int outputSize = swr_get_out_samples(converter, inputSize);
+		int result = outputSize;
+
+		if (outputSize > 0)
+		{
+			result = av_samples_get_buffer_size(
+				nullptr, channels, outputSize, codecContext->sample_fmt, 1);
+		}
+
+		if (outputSize > 0 && result > 0)
+		{
+			if (convertBuffer.size() < static_cast<size_t>(result))
+			{
+				convertBuffer.resize(result);
+			}
+
+			av_samples_fill_arrays(
+				planes.data(),
+				nullptr,
+				convertBuffer.data(),
+				channels,
+				outputSize,
+				codecContext->sample_fmt,
+				1);
+
+			const uint8_t* input[] = { data };
+
+			result = swr_convert(
+				converter,
+				planes.data(),
+				outputSize,
+				flushing == true ? nullptr : input,
+				inputSize);
+
+			if (result > 0 &&
+				av_audio_fifo_write(
+					fifo, reinterpret_cast<void**>(planes.data()), result) <
+				result)
+			{
+				result = AVERROR(ENOMEM);
+			}
+		}
+
+		if (result < 0)
+		{
+			SetError("Could not convert the samples", result);
+			return false;
+		}
+
+		// Whole frames are sent as they fill, and once flushing, the
+		// remainder as a short last frame, which the encoders allow.
+		bool written = true;
+		int available = av_audio_fifo_size(fifo);
+
+		while (written == true &&
+			(available >= frameSize || (flushing == true && available > 0)))
+		{
+			int count = std::min(available, frameSize);
+
+			// The encoder may still hold the last frame's buffers.
+			result = av_frame_make_writable(frame);
+
+			if (result >= 0)
+			{
+				frame->nb_samples = count;
+
+				result = av_audio_fifo_read(
+					fifo, reinterpret_cast<void**>(frame->extended_data), count);
+			}
+
+			if (result < 0)
+			{
+				SetError("Could not read the buffered samples", result);
+				written = false;
+			}
+			else
+			{
+				frame->pts = nextPts;
+				nextPts += count;
+
+				written = WritePackets(frame);
+			}
+
+			available = av_audio_fifo_size(fifo);
+		}
+
+		if (written == true && flushing == true)
+		{
+			written = WritePackets(nullptr);
+		}
+
+		return written;
+	}
+
+	bool AudioTranscoder::WriteCoverArt()
+	{
+		bool written = true;
+
+		for (size_t index = 0;
+			index < coverArt.size() && written == true;
+			index++)
+		{
+			const AVStream* source = coverArt[index].first;
+			AVStream* picture = coverArt[index].second;
+
+			// The muxer takes the reference, leaving the source's picture
+			// as it was.
+			int result = av_packet_ref(packet, &source->attached_pic);
+
+			if (result >= 0)
+			{
+				packet->stream_index = picture->index;
+				result = av_interleaved_write_frame(formatContext, packet);
+			}
+
+			if (result < 0)
+			{
+				SetError("Could not write the cover art", result);
+				written = false;
+			}
+		}
+
+		return written;
+	}
+
+	bool AudioTranscoder::WritePackets(AVFrame* input)
+	{
+		int result = avcodec_send_frame(codecContext, input);
+
+		while (result >= 0)
+		{
+			result = avcodec_receive_packet(codecContext, packet);
+
+			if (result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+			{
+				return true;
+			}
+
+			if (result >= 0)
+			{
+				av_packet_rescale_ts(
+					packet, codecContext->time_base, stream->time_base);
+				packet->stream_index = stream->index;
+
+				result = av_interleaved_write_frame(formatContext, packet);
+			}
+		}
+
+		SetError("Could not encode the audio", result);
+
+		return false;
+	}
+
+	void CopyTags(
+		AVDictionary** tags,
+		const AVFormatContext* formatContext,
+		const AVStream* stream)
+	{
+		// Ogg keeps its tags on the stream rather than the container, so
+		// the stream's are taken where the container has none.
+		const AVDictionary* source = formatContext->metadata;
+
+		if (av_dict_count(source) == 0)
+		{
+			source = stream->metadata;
+		}
+
+		av_dict_copy(tags, source, 0);
+
+		for (const char* tag : ContainerTags)
+		{
+			av_dict_set(tags, tag, nullptr, 0);
+		}
+	}
+
+	void GetDefaultTranscodeOptions(TranscodeOptions* options)
+	{
+		if (options != nullptr)
+		{
+			options->encoder = "flac";
+			options->bitRate = 0;
+			options->compressionLevel = -1;
+			options->threadCount = 0;
+			options->overwrite = 0;
+			options->cancellation = nullptr;
+		}
+	}
+
+	bool HasCoverArt(const AVOutputFormat* format)
+	{
+		// The muxers that store attached pictures as cover art.  Others
+		// would take the picture as a video stream, or refuse it.
+		static const char* const formats[] =
+		{
+			"flac", "ipod", "mov", "mp3", "mp4"
+		};
+
+		bool hasCoverArt = false;
+
+		for (const char* name : formats)
+		{
+			if (std::strcmp(format->name, name) == 0)
+			{
+				hasCoverArt = true;
+			}
+		}
+
+		return hasCoverArt;
+	}
+
+	bool IsValidTranscodeOptions(const TranscodeOptions& options)
+	{
+		bool valid = options.encoder != nullptr &&
+			options.bitRate >= 0 &&
+			options.compressionLevel >= -1 &&
+			options.threadCount >= 0;
+
+		return valid;
+	}
+
+	void PickChannelLayout(
+		const AVCodec* codec,
+		const AVChannelLayout& source,
+		AVChannelLayout* layout)
+	{
+		// The source's layout where the encoder takes it, otherwise mixed
+		// down to stereo, as MP3 tops out at.
+		bool supported = codec->ch_layouts == nullptr;
+
+		for (const AVChannelLayout* candidate = codec->ch_layouts;
+			candidate != nullptr && candidate->nb_channels != 0;
+			candidate++)
+		{
+			if (av_channel_layout_compare(candidate, &source) == 0)
+			{
+				supported = true;
+			}
+		}
+
+		if (supported == true)
+		{
+			av_channel_layout_copy(layout, &source);
+		}
+		else
+		{
+			av_channel_layout_default(
+				layout, std::min(source.nb_channels, 2));
+		}
+	}
+
+	AVSampleFormat PickSampleFormat(
+		const AVCodec* codec, AVSampleFormat format)
+	{
+		// The source's own format, packed or planar, where the encoder
+		// takes it, otherwise one at least as wide, so that a 24 bit
+		// source is not cut down to 16.
+		AVSampleFormat picked = format;
+
+		if (codec->sample_fmts != nullptr)
+		{
+			picked = codec->sample_fmts[0];
+
+			int width = av_get_bytes_per_sample(format);
+			bool exact = false;
+
+			for (const AVSampleFormat* candidate = codec->sample_fmts;
+				*candidate != AV_SAMPLE_FMT_NONE;
+				candidate++)
+			{
+				if (exact == false &&
+					av_get_packed_sample_fmt(*candidate) == format)
+				{
+					picked = *candidate;
+					exact = true;
+				}
+				else if (exact == false &&
+					av_get_bytes_per_sample(picked) < width &&
+					av_get_bytes_per_sample(*candidate) >
+						av_get_bytes_per_sample(picked))
+				{
+					picked = *candidate;
+				}
+			}
+		}
+
+		return picked;
+	}
+
+	int PickSampleRate(const AVCodec* codec, int sampleRate)
+	{
+		// The source's rate where the encoder takes it, otherwise the
+		// nearest it does, as MP3 tops out at 48 kHz.
+		int picked = sampleRate;
+
+		if (codec->supported_samplerates != nullptr)
+		{
+			picked = codec->supported_samplerates[0];
+
+			for (const int* rate = codec->supported_samplerates;
+				*rate != 0;
+				rate++)
+			{
+				if (std::abs(*rate - sampleRate) <
+					std::abs(picked - sampleRate))
+				{
+					picked = *rate;
+				}
+			}
+		}
+
+		return picked;
+	}
+
+	void RejectDuplicateOutputs(
+		const char** outputPaths, size_t count, int* statuses)
+	{
+		// The first index given each output, compared as the file system
+		// would, so that outputs that only look different still match.
+		std::map<std::filesystem::path::string_type, size_t> firstIndexes;
+
+		for (size_t index = 0; index < count; index++)
+		{
+			if (outputPaths[index] != nullptr)
+			{
+				std::error_code error;
+				std::filesystem::path path =
+					std::filesystem::weakly_canonical(
+						outputPaths[index], error);
+
+				if (error)
+				{
+					path = std::filesystem::path(
+						outputPaths[index]).lexically_normal();
+				}
+
+				std::filesystem::path::string_type key = path.native();
+
+#ifdef _WIN32
+				std::transform(key.begin(), key.end(), key.begin(),
+					[](wchar_t character)
+					{
+						return static_cast<wchar_t>(
+							std::towlower(character));
+					});
+#endif
+
+				auto [first, added] = firstIndexes.emplace(key, index);
+
+				if (added == false)
+				{
+					statuses[first->second] = SignatureInvalidArgument;
+					statuses[index] = SignatureInvalidArgument;
+				}
+			}
+		}
+	}
+
+	int TranscodeAudioFiles(
+		const char** inputPaths,
+		const char** outputPaths,
+		size_t count,
+		const TranscodeOptions* options,
+		int* statuses)
+	{
+		std::atomic<int> successCount = 0;
+
+		if (inputPaths != nullptr &&
+			outputPaths != nullptr &&
+			statuses != nullptr &&
+			count > 0)
+		{
+			TranscodeOptions transcodeOptions;
+			GetDefaultTranscodeOptions(&transcodeOptions);
+
+			if (options != nullptr)
+			{
+				transcodeOptions = *options;
+			}
+
+			bool valid = IsValidTranscodeOptions(transcodeOptions);
+
+			std::fill(
+				statuses,
+				statuses + count,
+				valid == true ? SignatureFailed : SignatureInvalidArgument);
+
+			if (valid == true)
+			{
+				// Two workers writing one output would each replace the
+				// other's file, so neither is transcoded.
+				RejectDuplicateOutputs(outputPaths, count, statuses);
+
+				std::atomic<size_t> nextIndex = 0;
+
+				size_t workerCount =
+					GetWorkerCount(transcodeOptions.threadCount, count);
+
+				// As GetAudioSignatures, each worker owns its transcoder
+				// and pulls the next unclaimed index, with each status
+				// landing in its input slot.
+				auto worker = [&]()
+				{
+					AudioTranscoder transcoder(transcodeOptions);
+					std::shared_ptr<spdlog::logger> logger = GetLogger();
+
+					size_t index = nextIndex++;
+
+					while (index < count)
+					{
+						int status = SignatureInvalidArgument;
+
+						if (inputPaths[index] != nullptr &&
+							outputPaths[index] != nullptr &&
+							statuses[index] != SignatureInvalidArgument)
+						{
+							status = transcoder.Run(
+								inputPaths[index], outputPaths[index]);
+						}
+
+						if (status == SignatureSuccess)
+						{
+							successCount++;
+						}
+						else if (status == SignatureFailed)
+						{
+							logger->error(
+								"ERROR: Could not transcode {}: {}",
+								inputPaths[index],
+								transcoder.GetError());
+						}
+
+						statuses[index] = status;
+						index = nextIndex++;
+					}
+				};
+
+				std::vector<std::thread> workers;
+				workers.reserve(workerCount);
+
+				for (size_t index = 0; index < workerCount; index++)
+				{
+					workers.emplace_back(worker);
+				}
+
+				for (std::thread& thread : workers)
+				{
+					thread.join();
+				}
+			}
+		}
+
+		return successCount;
+	}
+}
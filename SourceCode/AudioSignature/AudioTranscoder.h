@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C"
+{
+	#include <libavcodec/avcodec.h>
+	#include <libavformat/avformat.h>
+	#include <libavutil/audio_fifo.h>
+	#include <libswresample/swresample.h>
+}
+
+#include "AudioReader.h"
+#include "AudioSignature.h"
+
+namespace AudioSignature
+{
+	// Converts one file at a time to another codec, in process, with the
+	// tags and cover art carried across.  The audio is decoded by an
+	// AudioReader, converted by swresample to the sample format, rate and
+	// channels the encoder takes, and cut by a FIFO into the frame size
+	// the encoder wants.  One transcoder can be used for any number of
+	// files, but only by one thread at a time.
+	class AudioTranscoder
+	{
+	public:
+		AudioTranscoder(const TranscodeOptions& options);
+		~AudioTranscoder();
+
+		AudioTranscoder(const AudioTranscoder&) = delete;
+		AudioTranscoder& operator=(const AudioTranscoder&) = delete;
+
+		// Why the last file failed, if it did.
+		std::string GetError() const;
+
+		// Transcodes the file, returning a SignatureStatus.
+		int Run(const std::string& inputPath, const std::string& outputPath);
+
+	private:
+		bool AddCoverArt();
+		void Close();
+		bool OpenConverter();
+		bool OpenEncoder(const std::string& outputPath);
+		bool OpenOutput(const std::string& temporaryPath);
+		void SetError(const std::string& message, int errorCode = 0);
+		bool Transcode(
+			const std::string& inputPath,
+			const std::string& outputPath,
+			const std::string& temporaryPath);
+		bool WriteAudio(const uint8_t* data, size_t frames);
+		bool WriteCoverArt();
+		bool WritePackets(AVFrame* frame);
+
+		TranscodeOptions options;
+		AudioReader reader;
+
+		AVAudioFifo* fifo = nullptr;
+		AVCodecContext* codecContext = nullptr;
+		AVFormatContext* formatContext = nullptr;
+		AVFrame* frame = nullptr;
+		AVPacket* packet = nullptr;
+		AVStream* stream = nullptr;
+		SwrContext* converter = nullptr;
+
+		// The source's pictures, each with the stream it is copied to, if
+		// the output container can hold them.
+		std::vector<std::pair<const AVStream*, AVStream*>> coverArt;
+
+		// The converted samples, with one plane per channel for the planar
+		// formats, on their way to the FIFO.
+		std::vector<uint8_t> convertBuffer;
+		std::vector<uint8_t*> planes;
+
+		// The samples per frame sent to the encoder, and the timestamp of
+		// the next, in samples.
+		int frameSize = 0;
+		int64_t nextPts = 0;
+
+		// Ends the name each output is written to before it is complete,
+		// different for each transcoder, so that two never write the same
+		// file.
+		std::string partialSuffix;
+
+		std::string error;
+	};
+}
@@ -0,0 +1,385 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+	defined(__i386__)
+	#define X86_VECTORS
+
+	#include <immintrin.h>
+#endif
+
+#include "FastResampler.h"
+#include "FingerprintCompare.h"
+
+#if defined(X86_VECTORS) && defined(__GNUC__)
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define TARGET_AVX2
+#endif
+
+namespace AudioSignature
+{
+	using DotProductFunction = float (*)(const float*, const float*, size_t);
+
+	// The taps of each filter phase, in input samples.  Enough to bring
+	// the aliases of everything above 11025 Hz's Nyquist down out of the
+	// range chromaprint's chroma features look at.
+	const int FilterTaps = 128;
+
+	DotProductFunction GetDotProductFunction();
+
+	#ifdef X86_VECTORS
+		float DotProductAvx2(
+			const float* first, const float* second, size_t count);
+	#endif
+
+	FastResampler::FastResampler()
+	{
+	}
+
+	bool FastResampler::IsSupported(
+		AVSampleFormat format,
+		int channels,
+		int inputRate,
+		int outputChannels,
+		int outputRate)
+	{
+		bool supported = false;
+
+		bool formatSupported =
+			format == AV_SAMPLE_FMT_FLT || format == AV_SAMPLE_FMT_FLTP ||
+			format == AV_SAMPLE_FMT_S16 || format == AV_SAMPLE_FMT_S16P ||
+			format == AV_SAMPLE_FMT_S32 || format == AV_SAMPLE_FMT_S32P;
+
+		if (formatSupported == true &&
+			(channels == 1 || channels == 2) &&
+			(inputRate == 44100 || inputRate == 48000) &&
+			outputChannels == 1 &&
+			outputRate == 11025)
+		{
+			supported = true;
+		}
+
+		return supported;
+	}
+
+	bool FastResampler::Open(
+		AVSampleFormat format,
+		int channels,
+		int inputRate,
+		int outputRate)
+	{
+		if (inputRate <= 0 || outputRate <= 0)
+		{
+			return false;
+		}
+
+		this->format = format;
+		this->channels = channels;
+
+		int64_t divisor = std::gcd(inputRate, outputRate);
+		interpolation = outputRate / divisor;
+		decimation = inputRate / divisor;
+
+		// A windowed sinc, at the rate the input would be if upsampled by
+		// the interpolation, cut off at the output's Nyquist.  The center
+		// is half the length, rather than the middle tap, so that the
+		// delay is a whole number of input samples, which the silence
+		// below makes up for.
+		size_t length = static_cast<size_t>(FilterTaps * interpolation);
+		double cutoff = 0.5 / static_cast<double>(decimation);
+		double center = length / 2.0;
+
+		std::vector<double> prototype(length);
+
+		for (size_t index = 0; index < length; index++)
+		{
+			double time = static_cast<double>(index) - center;
+			double sinc = 2.0 * cutoff;
+
+			if (time != 0.0)
+			{
+				double angle = 2.0 * std::numbers::pi * cutoff * time;
+				sinc = std::sin(angle) / (std::numbers::pi * time);
+			}
+
+			double position = 2.0 * std::numbers::pi * time / length;
+			double window = 0.42 + 0.5 * std::cos(position) +
+				0.08 * std::cos(2.0 * position);
+
+			prototype[index] = sinc * window;
+		}
+
+		// Each phase is scaled to unity gain on its own, so that the
+		// phases of the 48 kHz filter agree on the level.
+		filter.resize(length);
+
+		for (int64_t phase = 0; phase < interpolation; phase++)
+		{
+			float* coefficients = filter.data() + phase * FilterTaps;
+			double sum = 0.0;
+
+			for (int tap = 0; tap < FilterTaps; tap++)
+			{
+				int64_t index = (FilterTaps - 1 - tap) * interpolation + phase;
+				sum += prototype[index];
+			}
+
+			for (int tap = 0; tap < FilterTaps; tap++)
+			{
+				int64_t index = (FilterTaps - 1 - tap) * interpolation + phase;
+				coefficients[tap] = static_cast<float>(prototype[index] / sum);
+			}
+		}
+
+		// Half a filter of silence first, so that the first output
+		// sample is centered on the first input sample, as swresample's
+		// are.
+		samples.assign(FilterTaps / 2 - 1, 0.0f);
+		outputCount = 0;
+		inputCount = 0;
+		dropped = 0;
+
+		return true;
+	}
+
+	size_t FastResampler::Convert(
+		const uint8_t* const* input,
+		int inputSize,
+		std::vector<uint8_t>& output)
+	{
+		bool flushing = input == nullptr;
+
+		if (flushing == true)
+		{
+			samples.resize(samples.size() + FilterTaps / 2, 0.0f);
+		}
+		else
+		{
+			Mix(input, inputSize);
+		}
+
+		size_t limit = static_cast<size_t>(
+			(samples.size() * interpolation) / decimation + 1);
+
+		if (output.size() < limit * sizeof(int16_t))
+		{
+			output.resize(limit * sizeof(int16_t));
+		}
+
+		int16_t* outputSamples = reinterpret_cast<int16_t*>(output.data());
+		size_t size = 0;
+
+		while (size < limit)
+		{
+			// Output sample n lies n * decimation / interpolation samples
+			// into the input, with the remainder picking the phase.
+			int64_t position = outputCount * decimation;
+			int64_t index = position / interpolation;
+			int64_t phase = position % interpolation;
+			int64_t start = index - dropped;
+
+			if (start + FilterTaps > static_cast<int64_t>(samples.size()) ||
+				(flushing == true && index >= inputCount))
+			{
+				break;
+			}
+
+			float value = DotProduct(
+				samples.data() + start,
+				filter.data() + phase * FilterTaps,
+				FilterTaps);
+
+			float scaled = std::clamp(value * 32768.0f, -32768.0f, 32767.0f);
+			outputSamples[size] = static_cast<int16_t>(std::lrint(scaled));
+
+			size++;
+			outputCount++;
+		}
+
+		// Drop the samples no later output sample reaches back to.
+		int64_t next = (outputCount * decimation) / interpolation - dropped;
+		next = std::clamp<int64_t>(
+			next, 0, static_cast<int64_t>(samples.size()));
+
+		samples.erase(samples.begin(), samples.begin() + next);
+		dropped += next;
+
+		return size;
+	}
+
+	void FastResampler::Mix(const uint8_t* const* input, int inputSize)
+	{
+		size_t offset = samples.size();
+		samples.resize(offset + inputSize);
+
+		float* mixed = samples.data() + offset;
+		bool stereo = channels == 2;
+
+		// The channels are averaged, as swresample's default matrix does
+		// for stereo to mono.
+		switch (format)
+		{
+			case AV_SAMPLE_FMT_FLTP:
+			{
+				const float* left = reinterpret_cast<const float*>(input[0]);
+				const float* right = reinterpret_cast<const float*>(
+					input[stereo ? 1 : 0]);
+
+				for (int index = 0; index < inputSize; index++)
+				{
+					mixed[index] = (left[index] + right[index]) * 0.5f;
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_FLT:
+			{
+				const float* data = reinterpret_cast<const float*>(input[0]);
+
+				for (int index = 0; index < inputSize; index++)
+				{
+					const float* frame = data + index * channels;
+					mixed[index] = (frame[0] + frame[channels - 1]) * 0.5f;
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S16P:
+			{
+				const int16_t* left =
+					reinterpret_cast<const int16_t*>(input[0]);
+				const int16_t* right = reinterpret_cast<const int16_t*>(
+					input[stereo ? 1 : 0]);
+
+				for (int index = 0; index < inputSize; index++)
+				{
+					mixed[index] =
+						(left[index] + right[index]) * (0.5f / 32768.0f);
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S16:
+			{
+				const int16_t* data =
+					reinterpret_cast<const int16_t*>(input[0]);
+
+				for (int index = 0; index < inputSize; index++)
+				{
+					const int16_t* frame = data + index * channels;
+					mixed[index] =
+						(frame[0] + frame[channels - 1]) * (0.5f / 32768.0f);
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S32P:
+			{
+				const int32_t* left =
+					reinterpret_cast<const int32_t*>(input[0]);
+				const int32_t* right = reinterpret_cast<const int32_t*>(
+					input[stereo ? 1 : 0]);
+
+				for (int index = 0; index < inputSize; index++)
+				{
+					mixed[index] = (static_cast<float>(left[index]) +
+						static_cast<float>(right[index])) *
+						(0.5f / 2147483648.0f);
+				}
+				break;
+			}
+			case AV_SAMPLE_FMT_S32:
+			{
+				const int32_t* data =
+					reinterpret_cast<const int32_t*>(input[0]);
+
+				for (int index = 0; index < inputSize; index++)
+				{
+					const int32_t* frame = data + index * channels;
+					mixed[index] = (static_cast<float>(frame[0]) +
+						static_cast<float>(frame[channels - 1])) *
+						(0.5f / 2147483648.0f);
+				}
+				break;
+			}
+			default:
+				std::fill(mixed, mixed + inputSize, 0.0f);
+				break;
+		}
+
+		inputCount += inputSize;
+	}
+
+	float DotProduct(const float* first, const float* second, size_t count)
+	{
+		static const DotProductFunction dotProduct = GetDotProductFunction();
+
+		return dotProduct(first, second, count);
+	}
+
+	float DotProductScalar(
+		const float* first, const float* second, size_t count)
+	{
+		float sum = 0.0f;
+
+		for (size_t index = 0; index < count; index++)
+		{
+			sum += first[index] * second[index];
+		}
+
+		return sum;
+	}
+
+	DotProductFunction GetDotProductFunction()
+	{
+		DotProductFunction function = DotProductScalar;
+
+		#ifdef X86_VECTORS
+			if (HasAvx2())
+			{
+				function = DotProductAvx2;
+			}
+		#endif
+
+		return function;
+	}
+
+	#ifdef X86_VECTORS
+		// Two accumulators of eight lanes each, to hide the latency of
+		// the additions.
+		TARGET_AVX2 float DotProductAvx2(
+			const float* first, const float* second, size_t count)
+		{
+			__m256 totals = _mm256_setzero_ps();
+			__m256 moreTotals = _mm256_setzero_ps();
+			size_t index = 0;
+
+			for (; index + 16 <= count; index += 16)
+			{
+				__m256 products = _mm256_mul_ps(
+					_mm256_loadu_ps(first + index),
+					_mm256_loadu_ps(second + index));
+				__m256 moreProducts = _mm256_mul_ps(
+					_mm256_loadu_ps(first + index + 8),
+					_mm256_loadu_ps(second + index + 8));
+
+				totals = _mm256_add_ps(totals, products);
+				moreTotals = _mm256_add_ps(moreTotals, moreProducts);
+			}
+
+			totals = _mm256_add_ps(totals, moreTotals);
+
+			__m128 half = _mm_add_ps(
+				_mm256_castps256_ps128(totals),
+				_mm256_extractf128_ps(totals, 1));
+			half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+			half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+
+			float sum = _mm_cvtss_f32(half);
+
+			sum += DotProductScalar(
+				first + index, second + index, count - index);
+
+			return sum;
+		}
+	#endif
+}
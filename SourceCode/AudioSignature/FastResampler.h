@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C"
+{
+	#include <libavutil/samplefmt.h>
+}
+
+namespace AudioSignature
+{
+	// Converts mono or stereo 44.1 or 48 kHz audio straight to the 16 bit
+	// mono 11025 Hz that chromaprint works on, mixing the channels down as
+	// the samples are read and filtering with a polyphase low-pass FIR.
+	// At 44.1 kHz this is a plain 4:1 decimation, and at 48 kHz one of 147
+	// phases is picked per output sample.  The result is close to, but not
+	// bit for bit the same as, swresample's.
+	class FastResampler
+	{
+	public:
+		FastResampler();
+
+		// Whether the input format and rates are ones handled here.
+		static bool IsSupported(
+			AVSampleFormat format,
+			int channels,
+			int inputRate,
+			int outputChannels,
+			int outputRate);
+
+		// Resets the filter state, and builds the filter for the rates.
+		bool Open(
+			AVSampleFormat format,
+			int channels,
+			int inputRate,
+			int outputRate);
+
+		// Converts a decoded frame, replacing the contents of output with
+		// 16 bit mono samples, and returns the number written.  A null
+		// input flushes the samples still held by the filter.
+		size_t Convert(
+			const uint8_t* const* input,
+			int inputSize,
+			std::vector<uint8_t>& output);
+
+	private:
+		void Mix(const uint8_t* const* input, int inputSize);
+
+		// The filter coefficients, taps per phase, with each phase
+		// reversed so that it lines up with the samples in order.
+		std::vector<float> filter;
+
+		// The mixed mono samples not yet passed by the filter.
+		std::vector<float> samples;
+
+		AVSampleFormat format = AV_SAMPLE_FMT_NONE;
+		int channels = 0;
+
+		// The reduced ratio of the rates, output to input.
+		int64_t interpolation = 1;
+		int64_t decimation = 1;
+
+		// The output samples written, the input samples mixed, and the
+		// input samples since dropped from the front of samples.
+		int64_t outputCount = 0;
+		int64_t inputCount = 0;
+		int64_t dropped = 0;
+	};
+
+	// The dot product of two runs of floats, using the widest vectors the
+	// processor supports.
+	float DotProduct(const float* first, const float* second, size_t count);
+
+	// The dot product one element at a time, as the reference for the
+	// vector version.
+	float DotProductScalar(
+		const float* first, const float* second, size_t count);
+}
@@ -0,0 +1,290 @@
+﻿#include <algorithm>
+#include <bit>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+	defined(__i386__)
+	#define X86_VECTORS
+
+	#include <immintrin.h>
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+#include "AudioSignature.h"
+#include "FingerprintCompare.h"
+
+// GCC and Clang only emit vector instructions in functions marked for
+// them, while MSVC allows the intrinsics anywhere.
+#if defined(X86_VECTORS) && defined(__GNUC__)
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+	#define TARGET_AVX512 \
+		__attribute__((target("avx512f,avx512vpopcntdq")))
+#else
+	#define TARGET_AVX2
+	#define TARGET_AVX512
+#endif
+
+namespace AudioSignature
+{
+	using CountBitErrorsFunction =
+		uint64_t (*)(const uint32_t*, const uint32_t*, size_t);
+
+	CountBitErrorsFunction GetCountBitErrorsFunction();
+
+	#ifdef X86_VECTORS
+		uint64_t CountBitErrorsAvx2(
+			const uint32_t* first, const uint32_t* second, size_t count);
+		uint64_t CountBitErrorsAvx512(
+			const uint32_t* first, const uint32_t* second, size_t count);
+		bool HasAvx512PopCount();
+	#endif
+
+	int CompareAudioSignatures(
+		const uint32_t* first,
+		size_t firstLength,
+		const uint32_t* second,
+		size_t secondLength,
+		int maxOffset,
+		double* bitErrorRate,
+		int* bestOffset)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (first != nullptr && second != nullptr && maxOffset >= 0 &&
+			bitErrorRate != nullptr && bestOffset != nullptr)
+		{
+			status = SignatureFailed;
+
+			// Very short overlaps can match by chance, so an alignment
+			// must cover at least half of the shorter fingerprint.
+			size_t shorter = std::min(firstLength, secondLength);
+			size_t minimumOverlap = std::max<size_t>(shorter / 2, 1);
+
+			const int64_t firstSize = static_cast<int64_t>(firstLength);
+			const int64_t secondSize = static_cast<int64_t>(secondLength);
+
+			// Offsets past the longer fingerprint leave no overlap, so the
+			// window stops there, however large the one asked for.
+			const int64_t limit = std::min<int64_t>(
+				maxOffset, std::max(firstSize, secondSize));
+
+			double bestRate = 1.0;
+
+			for (int64_t offset = -limit; offset <= limit; offset++)
+			{
+				// A positive offset means the second fingerprint starts
+				// that many items into the first.
+				int64_t firstStart = std::max<int64_t>(offset, 0);
+				int64_t secondStart = std::max<int64_t>(-offset, 0);
+
+				int64_t overlap = std::min(
+					firstSize - firstStart, secondSize - secondStart);
+
+				if (overlap < static_cast<int64_t>(minimumOverlap))
+				{
+					continue;
+				}
+
+				uint64_t errors = CountBitErrors(
+					first + firstStart,
+					second + secondStart,
+					static_cast<size_t>(overlap));
+
+				double rate = static_cast<double>(errors) / (overlap * 32.0);
+
+				if (status != SignatureSuccess || rate < bestRate)
+				{
+					bestRate = rate;
+					*bestOffset = static_cast<int>(offset);
+					status = SignatureSuccess;
+				}
+			}
+
+			if (status == SignatureSuccess)
+			{
+				*bitErrorRate = bestRate;
+			}
+		}
+
+		return status;
+	}
+
+	uint64_t CountBitErrors(
+		const uint32_t* first, const uint32_t* second, size_t count)
+	{
+		static const CountBitErrorsFunction countBitErrors =
+			GetCountBitErrorsFunction();
+
+		return countBitErrors(first, second, count);
+	}
+
+	uint64_t CountBitErrorsScalar(
+		const uint32_t* first, const uint32_t* second, size_t count)
+	{
+		uint64_t errors = 0;
+
+		for (size_t index = 0; index < count; index++)
+		{
+			errors += std::popcount(first[index] ^ second[index]);
+		}
+
+		return errors;
+	}
+
+	CountBitErrorsFunction GetCountBitErrorsFunction()
+	{
+		CountBitErrorsFunction function = CountBitErrorsScalar;
+
+		#ifdef X86_VECTORS
+			if (HasAvx512PopCount())
+			{
+				function = CountBitErrorsAvx512;
+			}
+			else if (HasAvx2())
+			{
+				function = CountBitErrorsAvx2;
+			}
+		#endif
+
+		return function;
+	}
+
+	#ifdef X86_VECTORS
+		// Counts the bits of each byte with a nibble lookup table, then
+		// sums the bytes into 64 bit lanes, as AVX2 has no population
+		// count of its own.
+		TARGET_AVX2 uint64_t CountBitErrorsAvx2(
+			const uint32_t* first, const uint32_t* second, size_t count)
+		{
+			const __m256i lookup = _mm256_setr_epi8(
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+				0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+			const __m256i lowMask = _mm256_set1_epi8(0x0f);
+			const __m256i zero = _mm256_setzero_si256();
+
+			__m256i totals = zero;
+			size_t index = 0;
+
+			for (; index + 8 <= count; index += 8)
+			{
+				__m256i left = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(first + index));
+				__m256i right = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(second + index));
+				__m256i bits = _mm256_xor_si256(left, right);
+
+				__m256i low = _mm256_and_si256(bits, lowMask);
+				__m256i high =
+					_mm256_and_si256(_mm256_srli_epi16(bits, 4), lowMask);
+				__m256i counts = _mm256_add_epi8(
+					_mm256_shuffle_epi8(lookup, low),
+					_mm256_shuffle_epi8(lookup, high));
+
+				totals =
+					_mm256_add_epi64(totals, _mm256_sad_epu8(counts, zero));
+			}
+
+			alignas(32) uint64_t lanes[4];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), totals);
+
+			uint64_t errors = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+			errors += CountBitErrorsScalar(
+				first + index, second + index, count - index);
+
+			return errors;
+		}
+
+		TARGET_AVX512 uint64_t CountBitErrorsAvx512(
+			const uint32_t* first, const uint32_t* second, size_t count)
+		{
+			__m512i totals = _mm512_setzero_si512();
+			size_t index = 0;
+
+			for (; index + 16 <= count; index += 16)
+			{
+				__m512i left = _mm512_loadu_si512(first + index);
+				__m512i right = _mm512_loadu_si512(second + index);
+				__m512i bits = _mm512_xor_si512(left, right);
+
+				totals = _mm512_add_epi64(totals, _mm512_popcnt_epi64(bits));
+			}
+
+			alignas(64) uint64_t lanes[8];
+			_mm512_store_si512(lanes, totals);
+
+			uint64_t errors = 0;
+
+			for (uint64_t lane : lanes)
+			{
+				errors += lane;
+			}
+
+			errors += CountBitErrorsScalar(
+				first + index, second + index, count - index);
+
+			return errors;
+		}
+	#endif
+
+	bool HasAvx2()
+	{
+		bool supported = false;
+
+		#if defined(X86_VECTORS) && defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+
+			if (info[0] >= 7)
+			{
+				__cpuid(info, 1);
+
+				bool osSupport = (info[2] & (1 << 27)) != 0 &&
+					(_xgetbv(0) & 0x06) == 0x06;
+
+				__cpuidex(info, 7, 0);
+
+				supported = osSupport && (info[1] & (1 << 5)) != 0;
+			}
+		#elif defined(X86_VECTORS)
+			supported = __builtin_cpu_supports("avx2");
+		#endif
+
+		return supported;
+	}
+
+	#ifdef X86_VECTORS
+		bool HasAvx512PopCount()
+		{
+			#ifdef _MSC_VER
+				int info[4];
+				__cpuid(info, 0);
+
+				bool supported = false;
+
+				if (info[0] >= 7)
+				{
+					__cpuid(info, 1);
+
+					// The operating system must save the ZMM registers.
+					bool osSupport = (info[2] & (1 << 27)) != 0 &&
+						(_xgetbv(0) & 0xe6) == 0xe6;
+
+					__cpuidex(info, 7, 0);
+
+					bool foundation = (info[1] & (1 << 16)) != 0;
+					bool popCount = (info[2] & (1 << 14)) != 0;
+
+					supported = osSupport && foundation && popCount;
+				}
+
+				return supported;
+			#else
+				return __builtin_cpu_supports("avx512f") &&
+					__builtin_cpu_supports("avx512vpopcntdq");
+			#endif
+		}
+	#endif
+}
@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioSignature
+{
+	// Counts the differing bits between two runs of raw fingerprint items,
+	// using the widest population count the processor supports.
+	uint64_t CountBitErrors(
+		const uint32_t* first, const uint32_t* second, size_t count);
+
+	// Counts the differing bits one item at a time.  Kept for processors
+	// without AVX2, and as the reference for the vector versions.
+	uint64_t CountBitErrorsScalar(
+		const uint32_t* first, const uint32_t* second, size_t count);
+
+	// Whether the processor, and the operating system, support AVX2.
+	// Always false on processors other than x86.
+	bool HasAvx2();
+}
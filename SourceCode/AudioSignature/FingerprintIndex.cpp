@@ -0,0 +1,288 @@
+﻿#include <algorithm>
+#include <mutex>
+
+#include "FingerprintIndex.h"
+
+namespace AudioSignature
+{
+	// Keys shared by a large part of the library, such as those from
+	// silence, say little about any one track, and would make each search
+	// walk a huge posting list, so they are skipped when searching.
+	const size_t MaximumPostingsPerKey = 10000;
+
+	FingerprintIndex::FingerprintIndex(int keyBits)
+	{
+		keyMask = 0xffffffffu;
+
+		if (keyBits < 32)
+		{
+			// Keep the most significant bits.
+			keyMask <<= 32 - keyBits;
+		}
+	}
+
+	bool FingerprintIndex::Add(
+		uint32_t trackId, const uint32_t* fingerprint, size_t length)
+	{
+		bool added = false;
+
+		if (fingerprint != nullptr && length > 0)
+		{
+			std::unique_lock<std::shared_mutex> lock(mutex);
+
+			std::vector<uint32_t>& keys = trackKeys[trackId];
+
+			RemovePostings(trackId, keys);
+			keys.clear();
+
+			uint32_t previousKey = 0;
+
+			for (size_t index = 0; index < length; index++)
+			{
+				uint32_t key = GetKey(fingerprint[index]);
+
+				// A run of the same value, as in a sustained note or
+				// silence, only needs indexing once.
+				if (index == 0 || key != previousKey)
+				{
+					Posting posting;
+					posting.trackId = trackId;
+					posting.position = static_cast<uint32_t>(index);
+
+					std::vector<Posting>& list = postings[key];
+
+					// The key's postings are only ever appended to, so
+					// the track is already there if it was the last.
+					if (list.empty() || list.back().trackId != trackId)
+					{
+						keys.push_back(key);
+					}
+
+					list.push_back(posting);
+				}
+
+				previousKey = key;
+			}
+
+			added = true;
+		}
+
+		return added;
+	}
+
+	size_t FingerprintIndex::GetTrackCount() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+
+		return trackKeys.size();
+	}
+
+	bool FingerprintIndex::Remove(uint32_t trackId)
+	{
+		bool removed = false;
+
+		std::unique_lock<std::shared_mutex> lock(mutex);
+
+		auto found = trackKeys.find(trackId);
+
+		if (found != trackKeys.end())
+		{
+			RemovePostings(trackId, found->second);
+			trackKeys.erase(found);
+			removed = true;
+		}
+
+		return removed;
+	}
+
+	void FingerprintIndex::RemovePostings(
+		uint32_t trackId, const std::vector<uint32_t>& keys)
+	{
+		for (uint32_t key : keys)
+		{
+			auto found = postings.find(key);
+
+			if (found != postings.end())
+			{
+				auto isTrack = [trackId](const Posting& posting)
+				{
+					return posting.trackId == trackId;
+				};
+
+				std::erase_if(found->second, isTrack);
+
+				if (found->second.empty())
+				{
+					postings.erase(found);
+				}
+			}
+		}
+	}
+
+	std::vector<FingerprintMatch> FingerprintIndex::Search(
+		const uint32_t* fingerprint,
+		size_t length,
+		uint32_t minimumMatches) const
+	{
+		std::vector<FingerprintMatch> matches;
+
+		// Votes are keyed by the track and the offset of the track's
+		// matching item relative to the query item.
+		std::unordered_map<uint64_t, uint32_t> votes;
+
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex);
+
+			for (size_t index = 0; index < length; index++)
+			{
+				auto found = postings.find(GetKey(fingerprint[index]));
+
+				if (found == postings.end() ||
+					found->second.size() > MaximumPostingsPerKey)
+				{
+					continue;
+				}
+
+				for (const Posting& posting : found->second)
+				{
+					int32_t offset = static_cast<int32_t>(
+						posting.position - static_cast<uint32_t>(index));
+					uint64_t vote =
+						(static_cast<uint64_t>(posting.trackId) << 32) |
+						static_cast<uint32_t>(offset);
+
+					votes[vote]++;
+				}
+			}
+		}
+
+		// Keep the best supported offset for each track, the smallest
+		// where offsets tie, so that the result does not depend on the
+		// order the votes are walked in.
+		std::unordered_map<uint32_t, FingerprintMatch> tracks;
+
+		for (const auto& [vote, count] : votes)
+		{
+			uint32_t trackId = static_cast<uint32_t>(vote >> 32);
+			int32_t offset = static_cast<int32_t>(vote & 0xffffffffu);
+
+			FingerprintMatch& match = tracks[trackId];
+
+			if (count > match.matches ||
+				(count == match.matches && offset < match.offset))
+			{
+				match.trackId = trackId;
+				match.matches = count;
+				match.offset = offset;
+			}
+		}
+
+		for (const auto& [trackId, match] : tracks)
+		{
+			if (match.matches >= minimumMatches)
+			{
+				matches.push_back(match);
+			}
+		}
+
+		std::sort(
+			matches.begin(),
+			matches.end(),
+			[](const FingerprintMatch& left, const FingerprintMatch& right)
+			{
+				// Ties are broken by the track id, so that equally good
+				// candidates always come in the same order.
+				bool before = left.matches > right.matches ||
+					(left.matches == right.matches &&
+					left.trackId < right.trackId);
+
+				return before;
+			});
+
+		return matches;
+	}
+
+	uint32_t FingerprintIndex::GetKey(uint32_t item) const
+	{
+		return item & keyMask;
+	}
+
+	FingerprintIndex* CreateFingerprintIndex(int keyBits)
+	{
+		FingerprintIndex* index = nullptr;
+
+		if (keyBits > 0 && keyBits <= 32)
+		{
+			index = new FingerprintIndex(keyBits);
+		}
+
+		return index;
+	}
+
+	void DestroyFingerprintIndex(FingerprintIndex* index)
+	{
+		delete index;
+	}
+
+	int FingerprintIndexAdd(
+		FingerprintIndex* index,
+		uint32_t trackId,
+		const uint32_t* fingerprint,
+		size_t length)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (index != nullptr &&
+			index->Add(trackId, fingerprint, length))
+		{
+			status = SignatureSuccess;
+		}
+
+		return status;
+	}
+
+	int FingerprintIndexRemove(FingerprintIndex* index, uint32_t trackId)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (index != nullptr)
+		{
+			status = SignatureFailed;
+
+			if (index->Remove(trackId))
+			{
+				status = SignatureSuccess;
+			}
+		}
+
+		return status;
+	}
+
+	int FingerprintIndexSearch(
+		FingerprintIndex* index,
+		const uint32_t* fingerprint,
+		size_t length,
+		uint32_t minimumMatches,
+		FingerprintMatch* matches,
+		size_t matchesSize,
+		size_t* count)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (index != nullptr && fingerprint != nullptr && count != nullptr &&
+			(matches != nullptr || matchesSize == 0))
+		{
+			std::vector<FingerprintMatch> found =
+				index->Search(fingerprint, length, minimumMatches);
+
+			// The best matches come first, so a short buffer keeps the
+			// most likely candidates.
+			*count = std::min(found.size(), matchesSize);
+			std::copy(found.begin(), found.begin() + *count, matches);
+
+			status = SignatureSuccess;
+		}
+
+		return status;
+	}
+}
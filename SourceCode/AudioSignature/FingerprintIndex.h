@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "AudioSignature.h"
+
+namespace AudioSignature
+{
+	// An inverted index from quantized sub-fingerprint values to the
+	// tracks, and the positions within them, where they occur.  Searching
+	// votes for each track by how far its matching items are shifted from
+	// the query, so tracks sharing a run of aligned audio stand out from
+	// chance matches.  Searches may run concurrently with each other, but
+	// not with additions or removals.
+	class FingerprintIndex
+	{
+	public:
+		explicit FingerprintIndex(int keyBits);
+
+		// Adds the track, replacing any fingerprint already added under
+		// the same id, as when a changed file is scanned again.
+		bool Add(
+			uint32_t trackId, const uint32_t* fingerprint, size_t length);
+		size_t GetTrackCount() const;
+
+		// Removes the track, returning false if it was not in the index.
+		bool Remove(uint32_t trackId);
+		std::vector<FingerprintMatch> Search(
+			const uint32_t* fingerprint,
+			size_t length,
+			uint32_t minimumMatches) const;
+
+	private:
+		struct Posting
+		{
+			uint32_t trackId;
+			uint32_t position;
+		};
+
+		uint32_t GetKey(uint32_t item) const;
+		void RemovePostings(
+			uint32_t trackId, const std::vector<uint32_t>& keys);
+
+		uint32_t keyMask;
+		mutable std::shared_mutex mutex;
+		std::unordered_map<uint32_t, std::vector<Posting>> postings;
+
+		// The keys each track has postings under, so that a track can be
+		// found and taken out again without walking the whole index.
+		std::unordered_map<uint32_t, std::vector<uint32_t>> trackKeys;
+	};
+}
@@ -0,0 +1,191 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#include "LoudnessMeter.h"
+
+namespace AudioSignature
+{
+	// The absolute gate, below which blocks are taken as silence.
+	const double AbsoluteGate = -70.0;
+
+	// How far below the loudness of the blocks passing the absolute gate
+	// the relative gate sits.
+	const double RelativeGate = -10.0;
+
+	// BS.1770 offsets the log of the power so that a 997 Hz sine at full
+	// scale, on one front channel, reads -3.01 LUFS.
+	const double LoudnessOffset = -0.691;
+
+	double GetLoudness(double power);
+	double GetPower(double loudness);
+
+	LoudnessMeter::LoudnessMeter()
+	{
+	}
+
+	void LoudnessMeter::Add(const float* samples, size_t frames)
+	{
+		for (size_t frame = 0; frame < frames; frame++)
+		{
+			const float* frameSamples = samples + frame * channels;
+
+			for (int channel = 0; channel < channels; channel++)
+			{
+				double sample = frameSamples[channel];
+				peak = std::max(peak, std::abs(sample));
+
+				double shelved = shelves[channel].Process(sample);
+				double weighted = highPasses[channel].Process(shelved);
+
+				stepSum += weights[channel] * weighted * weighted;
+			}
+
+			stepFill++;
+
+			if (stepFill == stepSize)
+			{
+				steps[stepCount % 4] = stepSum;
+				stepCount++;
+				stepFill = 0;
+				stepSum = 0.0;
+
+				if (stepCount >= 4)
+				{
+					double sum = steps[0] + steps[1] + steps[2] + steps[3];
+					double power = sum / static_cast<double>(stepSize * 4);
+
+					blocks.push_back(power);
+				}
+			}
+		}
+	}
+
+	double LoudnessMeter::GetIntegratedLoudness() const
+	{
+		double loudness = -std::numeric_limits<double>::infinity();
+
+		double absoluteGate = GetPower(AbsoluteGate);
+		double total = 0.0;
+		size_t count = 0;
+
+		for (double power : blocks)
+		{
+			if (power > absoluteGate)
+			{
+				total += power;
+				count++;
+			}
+		}
+
+		if (count > 0)
+		{
+			double relativeGate = std::max(absoluteGate,
+				GetPower(GetLoudness(total / count) + RelativeGate));
+
+			total = 0.0;
+			count = 0;
+
+			for (double power : blocks)
+			{
+				if (power > relativeGate)
+				{
+					total += power;
+					count++;
+				}
+			}
+
+			if (count > 0)
+			{
+				loudness = GetLoudness(total / count);
+			}
+		}
+
+		return loudness;
+	}
+
+	double LoudnessMeter::GetSamplePeak() const
+	{
+		return peak;
+	}
+
+	bool LoudnessMeter::Open(
+		int sampleRate, const std::vector<double>& weights)
+	{
+		if (sampleRate <= 0 || weights.empty())
+		{
+			return false;
+		}
+
+		this->weights = weights;
+		channels = static_cast<int>(weights.size());
+
+		// The filters of BS.1770 are given at 48 kHz, so are derived here
+		// from their analog prototypes for other rates, as libebur128
+		// does.
+		double rate = static_cast<double>(sampleRate);
+
+		Biquad shelf;
+		double frequency = 1681.974450955533;
+		double gain = 3.999843853973347;
+		double quality = 0.7071752369554196;
+
+		double k = std::tan(std::numbers::pi * frequency / rate);
+		double highGain = std::pow(10.0, gain / 20.0);
+		double bandGain = std::pow(highGain, 0.4996667741545416);
+		double a0 = 1.0 + k / quality + k * k;
+
+		shelf.b0 = (highGain + bandGain * k / quality + k * k) / a0;
+		shelf.b1 = 2.0 * (k * k - highGain) / a0;
+		shelf.b2 = (highGain - bandGain * k / quality + k * k) / a0;
+		shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+		shelf.a2 = (1.0 - k / quality + k * k) / a0;
+
+		Biquad highPass;
+		frequency = 38.13547087602444;
+		quality = 0.5003270373238773;
+
+		k = std::tan(std::numbers::pi * frequency / rate);
+		a0 = 1.0 + k / quality + k * k;
+
+		highPass.b0 = 1.0;
+		highPass.b1 = -2.0;
+		highPass.b2 = 1.0;
+		highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+		highPass.a2 = (1.0 - k / quality + k * k) / a0;
+
+		shelves.assign(channels, shelf);
+		highPasses.assign(channels, highPass);
+
+		blocks.clear();
+		std::fill(std::begin(steps), std::end(steps), 0.0);
+		stepCount = 0;
+		stepSize = static_cast<size_t>(std::lround(rate / 10.0));
+		stepFill = 0;
+		stepSum = 0.0;
+		peak = 0.0;
+
+		return true;
+	}
+
+	double LoudnessMeter::Biquad::Process(double input)
+	{
+		double output = b0 * input + z1;
+
+		z1 = b1 * input - a1 * output + z2;
+		z2 = b2 * input - a2 * output;
+
+		return output;
+	}
+
+	double GetLoudness(double power)
+	{
+		return LoudnessOffset + 10.0 * std::log10(power);
+	}
+
+	double GetPower(double loudness)
+	{
+		return std::pow(10.0, (loudness - LoudnessOffset) / 10.0);
+	}
+}
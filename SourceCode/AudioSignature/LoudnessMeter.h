@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace AudioSignature
+{
+	// Measures the integrated loudness of a programme, as EBU R128 and
+	// ITU-R BS.1770-4 define it, along with the sample peak.  The audio
+	// is K-weighted, its power taken over 400 ms blocks stepped by 100
+	// ms, and the blocks gated at -70 LUFS and then 10 LU below their
+	// own loudness.
+	class LoudnessMeter
+	{
+	public:
+		LoudnessMeter();
+
+		// Adds interleaved samples, at full scale of one, with frames
+		// counting the samples per channel.
+		void Add(const float* samples, size_t frames);
+
+		// The gated loudness of everything added, in LUFS, or negative
+		// infinity if no block was loud enough, as for silence, or audio
+		// shorter than one block.
+		double GetIntegratedLoudness() const;
+
+		// The largest absolute sample added, at full scale of one.
+		double GetSamplePeak() const;
+
+		// Resets the meter, and sets the filters up for the rate.  The
+		// weights scale each channel's power, as BS.1770 gives for its
+		// position, one for the front channels, 1.41 for the surrounds,
+		// and zero to leave out the LFE.
+		bool Open(int sampleRate, const std::vector<double>& weights);
+
+	private:
+		// A second order section, in transposed direct form II.
+		struct Biquad
+		{
+			double b0 = 1.0;
+			double b1 = 0.0;
+			double b2 = 0.0;
+			double a1 = 0.0;
+			double a2 = 0.0;
+			double z1 = 0.0;
+			double z2 = 0.0;
+
+			double Process(double input);
+		};
+
+		// The high shelf and high pass of the K-weighting, per channel.
+		std::vector<Biquad> shelves;
+		std::vector<Biquad> highPasses;
+		std::vector<double> weights;
+
+		// The weighted power of each full 400 ms block.
+		std::vector<double> blocks;
+
+		// The weighted sums of squares of the last four 100 ms steps,
+		// making up the block in progress.
+		double steps[4] = { 0.0, 0.0, 0.0, 0.0 };
+		size_t stepCount = 0;
+		size_t stepSize = 0;
+		size_t stepFill = 0;
+		double stepSum = 0.0;
+
+		int channels = 0;
+		double peak = 0.0;
+	};
+}
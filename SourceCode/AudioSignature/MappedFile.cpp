@@ -0,0 +1,214 @@
+﻿#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+namespace AudioSignature
+{
+	MappedFile::MappedFile()
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	const uint8_t* MappedFile::GetData() const
+	{
+		return data;
+	}
+
+	int64_t MappedFile::GetSize() const
+	{
+		return size;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return data != nullptr;
+	}
+
+	void MappedFile::Close()
+	{
+		#ifdef _WIN32
+			if (data != nullptr)
+			{
+				UnmapViewOfFile(data);
+			}
+
+			if (mappingHandle != nullptr)
+			{
+				CloseHandle(mappingHandle);
+				mappingHandle = nullptr;
+			}
+
+			if (fileHandle != nullptr)
+			{
+				CloseHandle(fileHandle);
+				fileHandle = nullptr;
+			}
+		#else
+			if (data != nullptr)
+			{
+				munmap(const_cast<uint8_t*>(data), static_cast<size_t>(size));
+			}
+		#endif
+
+		data = nullptr;
+		position = 0;
+		size = 0;
+	}
+
+	bool MappedFile::Open(const std::string& filePath)
+	{
+		Close();
+
+		std::filesystem::path path = filePath;
+
+		#ifdef _WIN32
+			HANDLE file = CreateFileW(
+				path.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			fileHandle = file;
+
+			LARGE_INTEGER fileSize;
+
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+			{
+				Close();
+				return false;
+			}
+
+			mappingHandle = CreateFileMappingW(
+				file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (mappingHandle == nullptr)
+			{
+				Close();
+				return false;
+			}
+
+			void* view =
+				MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+			if (view == nullptr)
+			{
+				Close();
+				return false;
+			}
+
+			data = static_cast<const uint8_t*>(view);
+			size = fileSize.QuadPart;
+		#else
+			int file = open(path.c_str(), O_RDONLY);
+
+			if (file < 0)
+			{
+				return false;
+			}
+
+			struct stat status;
+
+			if (fstat(file, &status) != 0 || status.st_size == 0)
+			{
+				close(file);
+				return false;
+			}
+
+			void* view = mmap(
+				nullptr,
+				static_cast<size_t>(status.st_size),
+				PROT_READ,
+				MAP_PRIVATE,
+				file,
+				0);
+
+			// The mapping holds its own reference to the file.
+			close(file);
+
+			if (view == MAP_FAILED)
+			{
+				return false;
+			}
+
+			madvise(view, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+
+			data = static_cast<const uint8_t*>(view);
+			size = status.st_size;
+		#endif
+
+		return true;
+	}
+
+	int MappedFile::Read(uint8_t* buffer, int bufferSize)
+	{
+		int64_t remaining = size - position;
+		int count = static_cast<int>(
+			std::min(remaining, static_cast<int64_t>(bufferSize)));
+
+		if (count > 0)
+		{
+			std::memcpy(buffer, data + position, count);
+			position += count;
+		}
+		else
+		{
+			count = 0;
+		}
+
+		return count;
+	}
+
+	int64_t MappedFile::Seek(int64_t offset, int whence)
+	{
+		int64_t newPosition = -1;
+
+		switch (whence)
+		{
+			case SEEK_SET:
+				newPosition = offset;
+				break;
+			case SEEK_CUR:
+				newPosition = position + offset;
+				break;
+			case SEEK_END:
+				newPosition = size + offset;
+				break;
+		}
+
+		if (newPosition < 0 || newPosition > size)
+		{
+			newPosition = -1;
+		}
+		else
+		{
+			position = newPosition;
+		}
+
+		return newPosition;
+	}
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace AudioSignature
+{
+	// A read only memory mapping of a whole file, with a read position,
+	// for serving a file to libavformat without buffered read calls.
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const uint8_t* GetData() const;
+		int64_t GetSize() const;
+		bool IsOpen() const;
+
+		void Close();
+		bool Open(const std::string& filePath);
+
+		// Copies up to bufferSize bytes from the current position, returning
+		// the number copied, which is zero at the end of the file.
+		int Read(uint8_t* buffer, int bufferSize);
+
+		// Moves the read position as fseek does, returning the new
+		// position, or -1 if it would fall outside the file.
+		int64_t Seek(int64_t offset, int whence);
+
+	private:
+		const uint8_t* data = nullptr;
+		int64_t position = 0;
+		int64_t size = 0;
+
+		#ifdef _WIN32
+			void* fileHandle = nullptr;
+			void* mappingHandle = nullptr;
+		#endif
+	};
+}
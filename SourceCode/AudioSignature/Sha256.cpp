@@ -0,0 +1,171 @@
+﻿#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "Sha256.h"
+
+namespace AudioSignature
+{
+	const uint32_t RoundConstants[64] =
+	{
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+		0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+		0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+		0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+		0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+		0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+		0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+		0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+		0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	Sha256::Sha256()
+	{
+		state =
+		{
+			0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+			0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+		};
+	}
+
+	std::string Sha256::Finish()
+	{
+		uint64_t bitCount = totalSize * 8;
+
+		uint8_t padding[72] = { 0x80 };
+		size_t paddingSize = (bufferSize < 56 ? 56 : 120) - bufferSize;
+
+		for (int index = 0; index < 8; index++)
+		{
+			padding[paddingSize + index] =
+				static_cast<uint8_t>(bitCount >> (56 - index * 8));
+		}
+
+		Update(padding, paddingSize + 8);
+
+		const char* digits = "0123456789abcdef";
+		std::string digest;
+		digest.reserve(64);
+
+		for (uint32_t word : state)
+		{
+			for (int shift = 28; shift >= 0; shift -= 4)
+			{
+				digest.push_back(digits[(word >> shift) & 0xf]);
+			}
+		}
+
+		return digest;
+	}
+
+	void Sha256::Update(const uint8_t* data, size_t size)
+	{
+		totalSize += size;
+
+		if (bufferSize > 0)
+		{
+			size_t count = std::min(size, buffer.size() - bufferSize);
+
+			memcpy(buffer.data() + bufferSize, data, count);
+			bufferSize += count;
+			data += count;
+			size -= count;
+
+			if (bufferSize == buffer.size())
+			{
+				Transform(buffer.data());
+				bufferSize = 0;
+			}
+		}
+
+		// Whole blocks are hashed straight from the input.
+		while (size >= buffer.size())
+		{
+			Transform(data);
+			data += buffer.size();
+			size -= buffer.size();
+		}
+
+		if (size > 0)
+		{
+			memcpy(buffer.data(), data, size);
+			bufferSize = size;
+		}
+	}
+
+	void Sha256::Transform(const uint8_t* block)
+	{
+		uint32_t words[64];
+
+		for (int index = 0; index < 16; index++)
+		{
+			const uint8_t* bytes = block + index * 4;
+
+			words[index] = (static_cast<uint32_t>(bytes[0]) << 24) |
+				(static_cast<uint32_t>(bytes[1]) << 16) |
+				(static_cast<uint32_t>(bytes[2]) << 8) |
+				static_cast<uint32_t>(bytes[3]);
+		}
+
+		for (int index = 16; index < 64; index++)
+		{
+			uint32_t low = words[index - 15];
+			uint32_t high = words[index - 2];
+
+			uint32_t sigma0 = std::rotr(low, 7) ^ std::rotr(low, 18) ^
+				(low >> 3);
+			uint32_t sigma1 = std::rotr(high, 17) ^ std::rotr(high, 19) ^
+				(high >> 10);
+
+			words[index] =
+				words[index - 16] + sigma0 + words[index - 7] + sigma1;
+		}
+
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+		uint32_t f = state[5];
+		uint32_t g = state[6];
+		uint32_t h = state[7];
+
+		for (int index = 0; index < 64; index++)
+		{
+			uint32_t sum1 =
+				std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25);
+			uint32_t choice = (e & f) ^ (~e & g);
+			uint32_t first =
+				h + sum1 + choice + RoundConstants[index] + words[index];
+			uint32_t sum0 =
+				std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22);
+			uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+			uint32_t second = sum0 + majority;
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + first;
+			d = c;
+			c = b;
+			b = a;
+			a = first + second;
+		}
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AudioSignature
+{
+	// An incremental SHA-256, as sha256sum computes, so that decoded audio
+	// can be hashed as it streams out of the reader.
+	class Sha256
+	{
+	public:
+		Sha256();
+
+		// Returns the digest as lower case hex.  The hash must not be
+		// updated after.
+		std::string Finish();
+		void Update(const uint8_t* data, size_t size);
+
+	private:
+		void Transform(const uint8_t* block);
+
+		std::array<uint32_t, 8> state;
+		std::array<uint8_t, 64> buffer;
+		size_t bufferSize = 0;
+		uint64_t totalSize = 0;
+	};
+}
@@ -0,0 +1,354 @@
+﻿#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#pragma warning( push )
+#include "../ChromaPrint/src/chromaprint.h"
+#pragma warning(pop)
+
+#include "SignatureCache.h"
+
+namespace AudioSignature
+{
+	// The version is part of the magic, so that a change of layout makes
+	// older caches simply start empty.
+	const char CacheMagic[8] = { 'A', 'S', 'C', 'A', 'C', 'H', 'E', '1' };
+
+	// Each record is this header, in native byte order, followed by the
+	// path and the signature, neither null terminated.
+	struct RecordHeader
+	{
+		uint32_t pathLength;
+		uint32_t signatureLength;
+		uint64_t size;
+		int64_t modified;
+		uint64_t optionsHash;
+	};
+
+	void HashBytes(uint64_t& hash, const void* data, size_t size);
+
+	SignatureCache::~SignatureCache()
+	{
+		Close();
+	}
+
+	bool SignatureCache::GetKey(
+		const char* filePath,
+		const SignatureOptions& options,
+		SignatureCacheKey& key)
+	{
+		bool result = false;
+
+		if (filePath != nullptr)
+		{
+			std::error_code error;
+			std::filesystem::path path =
+				std::filesystem::canonical(filePath, error);
+
+			if (!error)
+			{
+				key.size = std::filesystem::file_size(path, error);
+			}
+
+			if (!error)
+			{
+				auto modified = std::filesystem::last_write_time(path, error);
+				key.modified = modified.time_since_epoch().count();
+			}
+
+			if (!error)
+			{
+				std::u8string text = path.u8string();
+				key.path.assign(text.begin(), text.end());
+				key.optionsHash = GetOptionsHash(options);
+
+				result = true;
+			}
+		}
+
+		return result;
+	}
+
+	uint64_t SignatureCache::GetOptionsHash(const SignatureOptions& options)
+	{
+		// FNV-1a, over every option that changes the fingerprint, and the
+		// chromaprint version, in case an upgrade changes its output.  The
+		// input mode, decoder threads and read limits only change how the
+		// file is read, so are left out.
+		uint64_t hash = 14695981039346656037ull;
+
+		HashBytes(hash, &options.maxDuration, sizeof(options.maxDuration));
+		HashBytes(
+			hash, &options.maxChunkDuration, sizeof(options.maxChunkDuration));
+		HashBytes(hash, &options.overlap, sizeof(options.overlap));
+		HashBytes(hash, &options.algorithm, sizeof(options.algorithm));
+		HashBytes(hash, &options.startOffset, sizeof(options.startOffset));
+		HashBytes(hash, &options.resampleMode, sizeof(options.resampleMode));
+
+		const char* version = chromaprint_get_version();
+
+		if (version != nullptr)
+		{
+			HashBytes(hash, version, strlen(version));
+		}
+
+		return hash;
+	}
+
+	bool SignatureCache::IsOpen() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+
+		return open;
+	}
+
+	bool SignatureCache::Close()
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+
+		bool result = true;
+
+		if (open == true && changed == true)
+		{
+			result = Save();
+		}
+
+		Clear();
+
+		return result;
+	}
+
+	char* SignatureCache::Find(const SignatureCacheKey& key) const
+	{
+		char* signature = nullptr;
+
+		std::shared_lock<std::shared_mutex> lock(mutex);
+
+		auto found = entries.find({ key.path, key.optionsHash });
+
+		if (found != entries.end() &&
+			found->second.size == key.size &&
+			found->second.modified == key.modified)
+		{
+			std::string_view text = found->second.signature;
+
+			signature = static_cast<char*>(malloc(text.size() + 1));
+
+			if (signature != nullptr)
+			{
+				memcpy(signature, text.data(), text.size());
+				signature[text.size()] = 0;
+			}
+		}
+
+		return signature;
+	}
+
+	bool SignatureCache::Open(const std::string& filePath)
+	{
+		bool result = Close();
+
+		std::unique_lock<std::shared_mutex> lock(mutex);
+
+		cachePath = filePath;
+		open = true;
+
+		// A missing or unreadable cache is not an error, it just starts
+		// empty, and is written fresh on close.
+		if (mappedFile.Open(cachePath))
+		{
+			Load();
+		}
+
+		return result;
+	}
+
+	void SignatureCache::Store(
+		const SignatureCacheKey& key, const char* signature)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex);
+
+		if (open == true && signature != nullptr)
+		{
+			const std::string& text = storedSignatures.emplace_back(signature);
+
+			Entry entry;
+			entry.size = key.size;
+			entry.modified = key.modified;
+			entry.signature = text;
+
+			entries[{ key.path, key.optionsHash }] = entry;
+			changed = true;
+		}
+	}
+
+	size_t SignatureCache::EntryKeyHash::operator()(const EntryKey& key) const
+	{
+		size_t hash = std::hash<std::string>()(key.path);
+
+		hash ^= std::hash<uint64_t>()(key.optionsHash) +
+			0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+
+		return hash;
+	}
+
+	void SignatureCache::Clear()
+	{
+		entries.clear();
+		storedSignatures.clear();
+		mappedFile.Close();
+
+		cachePath.clear();
+		changed = false;
+		open = false;
+	}
+
+	void SignatureCache::Load()
+	{
+		const uint8_t* data = mappedFile.GetData();
+		size_t size = static_cast<size_t>(mappedFile.GetSize());
+
+		if (size >= sizeof(CacheMagic) &&
+			memcmp(data, CacheMagic, sizeof(CacheMagic)) == 0)
+		{
+			size_t position = sizeof(CacheMagic);
+
+			// Later records replace earlier ones for the same key.  A
+			// truncated record ends the load, keeping all before it.
+			while (size - position >= sizeof(RecordHeader))
+			{
+				RecordHeader header;
+				memcpy(&header, data + position, sizeof(header));
+				position += sizeof(header);
+
+				size_t length =
+					static_cast<size_t>(header.pathLength) +
+					header.signatureLength;
+
+				if (size - position < length)
+				{
+					break;
+				}
+
+				const char* text =
+					reinterpret_cast<const char*>(data + position);
+				position += length;
+
+				EntryKey key;
+				key.path.assign(text, header.pathLength);
+				key.optionsHash = header.optionsHash;
+
+				Entry entry;
+				entry.size = header.size;
+				entry.modified = header.modified;
+				entry.signature = std::string_view(
+					text + header.pathLength, header.signatureLength);
+
+				entries[std::move(key)] = entry;
+			}
+		}
+	}
+
+	bool SignatureCache::Save()
+	{
+		bool result = false;
+
+		std::string temporaryPath = cachePath + ".tmp";
+
+		{
+			std::ofstream file(
+				temporaryPath, std::ios::binary | std::ios::trunc);
+
+			file.write(CacheMagic, sizeof(CacheMagic));
+
+			for (const auto& [key, entry] : entries)
+			{
+				RecordHeader header;
+				header.pathLength = static_cast<uint32_t>(key.path.size());
+				header.signatureLength =
+					static_cast<uint32_t>(entry.signature.size());
+				header.size = entry.size;
+				header.modified = entry.modified;
+				header.optionsHash = key.optionsHash;
+
+				file.write(
+					reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(key.path.data(), key.path.size());
+				file.write(entry.signature.data(), entry.signature.size());
+			}
+
+			file.flush();
+			result = file.good();
+		}
+
+		if (result == true)
+		{
+			// The old cache must be unmapped before it can be replaced.
+			// The loaded entries point into it, so are not used after.
+			mappedFile.Close();
+
+			std::error_code error;
+			std::filesystem::rename(temporaryPath, cachePath, error);
+
+			result = !error;
+		}
+
+		if (result == false)
+		{
+			std::error_code error;
+			std::filesystem::remove(temporaryPath, error);
+		}
+
+		return result;
+	}
+
+	SignatureCache& GetSignatureCache()
+	{
+		static SignatureCache cache;
+
+		return cache;
+	}
+
+	void HashBytes(uint64_t& hash, const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		for (size_t index = 0; index < size; index++)
+		{
+			hash ^= bytes[index];
+			hash *= 1099511628211ull;
+		}
+	}
+
+	int CloseSignatureCache()
+	{
+		int status = SignatureFailed;
+
+		if (GetSignatureCache().Close())
+		{
+			status = SignatureSuccess;
+		}
+
+		return status;
+	}
+
+	int OpenSignatureCache(const char* cachePath)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (cachePath != nullptr && cachePath[0] != 0)
+		{
+			status = SignatureFailed;
+
+			// Opening saves any cache already open.
+			if (GetSignatureCache().Open(cachePath))
+			{
+				status = SignatureSuccess;
+			}
+		}
+
+		return status;
+	}
+}
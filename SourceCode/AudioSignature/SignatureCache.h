@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "AudioSignature.h"
+#include "MappedFile.h"
+
+namespace AudioSignature
+{
+	// Identifies one fingerprint of one version of a file.  Any change to
+	// the file's size or modification time, or to the options, gives a
+	// different key, so a stale fingerprint is never returned.
+	struct SignatureCacheKey
+	{
+		std::string path;
+		uint64_t size = 0;
+		int64_t modified = 0;
+		uint64_t optionsHash = 0;
+	};
+
+	// A persistent cache of text fingerprints, so that rescanning a
+	// library only decodes the files that have changed.  The cache file
+	// is mapped on open and its records are served in place; new records
+	// are kept in memory until Close, which rewrites the file through a
+	// temporary copy, so a crash never leaves a half written cache.
+	class SignatureCache
+	{
+	public:
+		SignatureCache() = default;
+		~SignatureCache();
+
+		SignatureCache(const SignatureCache&) = delete;
+		SignatureCache& operator=(const SignatureCache&) = delete;
+
+		static bool GetKey(
+			const char* filePath,
+			const SignatureOptions& options,
+			SignatureCacheKey& key);
+		static uint64_t GetOptionsHash(const SignatureOptions& options);
+
+		bool IsOpen() const;
+
+		bool Close();
+
+		// Returns a copy of the cached fingerprint, to be freed with
+		// FreeAudioSignature, or nullptr if there is none.
+		char* Find(const SignatureCacheKey& key) const;
+		bool Open(const std::string& filePath);
+		void Store(const SignatureCacheKey& key, const char* signature);
+
+	private:
+		struct Entry
+		{
+			uint64_t size;
+			int64_t modified;
+			std::string_view signature;
+		};
+
+		struct EntryKey
+		{
+			std::string path;
+			uint64_t optionsHash;
+
+			bool operator==(const EntryKey& other) const = default;
+		};
+
+		struct EntryKeyHash
+		{
+			size_t operator()(const EntryKey& key) const;
+		};
+
+		void Clear();
+		void Load();
+		bool Save();
+
+		std::string cachePath;
+		bool changed = false;
+		std::unordered_map<EntryKey, Entry, EntryKeyHash> entries;
+		MappedFile mappedFile;
+		mutable std::shared_mutex mutex;
+		bool open = false;
+
+		// Holds the fingerprints added since the cache was opened, as the
+		// loaded ones live in the mapping.
+		std::deque<std::string> storedSignatures;
+	};
+
+	SignatureCache& GetSignatureCache();
+}
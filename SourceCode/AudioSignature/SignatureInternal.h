@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#pragma warning( push )
+#include "spdlog/spdlog.h"
+#pragma warning(pop)
+
+#include "AudioReader.h"
+#include "AudioSignature.h"
+
+// Helpers defined in AudioSignature.cpp, shared with the other exported
+// calls.
+namespace AudioSignature
+{
+	// The status to report for a read that stopped early.
+	int GetInterruptionStatus(ReadInterruption interruption);
+
+	// The library's logger, made on first use.
+	std::shared_ptr<spdlog::logger> GetLogger();
+
+	// The threads to use for a number of items, given the caller's count.
+	size_t GetWorkerCount(int threadCount, size_t itemCount);
+
+	// Whether the options are present, and each in its range.
+	bool IsValidOptions(const SignatureOptions* options);
+
+	// The read limits that the options ask for.
+	ReadBudget MakeReadBudget(const SignatureOptions& options);
+}
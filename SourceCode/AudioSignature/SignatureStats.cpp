@@ -0,0 +1,93 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#include "AudioSignature.h"
+#include "SignatureStats.h"
+
+namespace AudioSignature
+{
+	// The totals for each codec since the last reset, kept in name order
+	// so that reads list them consistently.
+	std::mutex statsMutex;
+	std::map<std::string, SignatureStats> codecStats;
+
+	double GetSeconds(std::chrono::nanoseconds duration)
+	{
+		return std::chrono::duration<double>(duration).count();
+	}
+
+	void RecordStageTimes(
+		const std::string& codec, const StageTimes& times, double audioSeconds)
+	{
+		std::string name = codec;
+
+		if (name.empty())
+		{
+			// The file could not be opened far enough to find its codec.
+			name = "unknown";
+		}
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+
+		auto found = codecStats.find(name);
+
+		if (found == codecStats.end())
+		{
+			SignatureStats stats = {};
+
+			size_t length = std::min(name.size(), sizeof(stats.codec) - 1);
+			memcpy(stats.codec, name.data(), length);
+
+			found = codecStats.emplace(name, stats).first;
+		}
+
+		SignatureStats& stats = found->second;
+
+		stats.files++;
+		stats.audioSeconds += audioSeconds;
+		stats.openSeconds += GetSeconds(times.open);
+		stats.decodeSeconds += GetSeconds(times.decode);
+		stats.resampleSeconds += GetSeconds(times.resample);
+		stats.fingerprintSeconds += GetSeconds(times.fingerprint);
+		stats.finishSeconds += GetSeconds(times.finish);
+	}
+
+	int GetAudioSignatureStats(
+		SignatureStats* stats, size_t statsSize, size_t* count)
+	{
+		int status = SignatureInvalidArgument;
+
+		if (count != nullptr && (stats != nullptr || statsSize == 0))
+		{
+			std::lock_guard<std::mutex> lock(statsMutex);
+
+			*count = codecStats.size();
+
+			if (statsSize < codecStats.size())
+			{
+				status = SignatureBufferTooSmall;
+			}
+			else
+			{
+				for (const auto& [name, codec] : codecStats)
+				{
+					*stats = codec;
+					stats++;
+				}
+
+				status = SignatureSuccess;
+			}
+		}
+
+		return status;
+	}
+
+	void ResetAudioSignatureStats()
+	{
+		std::lock_guard<std::mutex> lock(statsMutex);
+
+		codecStats.clear();
+	}
+}
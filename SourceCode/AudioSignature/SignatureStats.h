@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace AudioSignature
+{
+	// The time one file spent in each stage of fingerprinting.
+	struct StageTimes
+	{
+		std::chrono::nanoseconds open{};
+		std::chrono::nanoseconds decode{};
+		std::chrono::nanoseconds resample{};
+		std::chrono::nanoseconds fingerprint{};
+		std::chrono::nanoseconds finish{};
+	};
+
+	// Adds the time from construction to destruction to a total.
+	class StageTimer
+	{
+	public:
+		explicit StageTimer(std::chrono::nanoseconds& total)
+			: total(total), start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~StageTimer()
+		{
+			total += std::chrono::steady_clock::now() - start;
+		}
+
+		StageTimer(const StageTimer&) = delete;
+		StageTimer& operator=(const StageTimer&) = delete;
+
+	private:
+		std::chrono::nanoseconds& total;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	// Adds one file's times to the process wide totals for its codec.
+	void RecordStageTimes(
+		const std::string& codec, const StageTimes& times, double audioSeconds);
+}
@@ -0,0 +1,80 @@
+﻿#include <algorithm>
+
+#include "WorkerPool.h"
+
+namespace AudioSignature
+{
+	WorkerPool::WorkerPool(size_t threadCount)
+	{
+		threads.reserve(threadCount);
+
+		for (size_t index = 0; index < threadCount; index++)
+		{
+			threads.emplace_back(&WorkerPool::Work, this);
+		}
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		condition.notify_all();
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	void WorkerPool::Submit(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back(std::move(job));
+		}
+
+		condition.notify_one();
+	}
+
+	void WorkerPool::Work()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				condition.wait(lock, [this]()
+				{
+					return stopping == true || !jobs.empty();
+				});
+
+				// Jobs still queued when stopping are dropped.
+				if (stopping == true)
+				{
+					break;
+				}
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+
+	WorkerPool& GetWorkerPool()
+	{
+		// Never destroyed, as joining threads while the library is being
+		// unloaded can deadlock on Windows.  The threads end with the
+		// process instead.
+		static WorkerPool* pool = new WorkerPool(
+			std::max(std::thread::hardware_concurrency(), 1u));
+
+		return *pool;
+	}
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AudioSignature
+{
+	// A fixed set of threads taking jobs from a shared queue, in the order
+	// submitted, for the asynchronous calls.
+	class WorkerPool
+	{
+	public:
+		explicit WorkerPool(size_t threadCount);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		void Submit(std::function<void()> job);
+
+	private:
+		void Work();
+
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<std::function<void()>> jobs;
+		std::vector<std::thread> threads;
+		bool stopping = false;
+	};
+
+	// The library's shared pool, with one thread per processor, started
+	// on first use.
+	WorkerPool& GetWorkerPool();
+}
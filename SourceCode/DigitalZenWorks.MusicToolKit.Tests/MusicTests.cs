@@ -10,6 +10,9 @@ namespace DigitalZenWorks.MusicToolKit.Tests;
 
 using System;
 using System.IO;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
 using DigitalZenWorks.MusicToolKit.Decoders;
 using DigitalZenWorks.RulesLibrary;
 using NUnit.Framework;
@@ -398,6 +401,134 @@ public void AudioSignatureTest()
 		Assert.That(audioSignature, Is.EqualTo(intended));
 	}
 
+	/// <summary>
+	/// The get audio signature asynchronously test.
+	/// </summary>
+	/// <returns>A task representing the asynchronous operation.</returns>
+	[Test]
+	public async Task AudioSignatureAsync()
+	{
+		string expected = AudioSignature.GetAudioSignature(TestFile);
+
+		Task<string> task = AudioSignature.GetAudioSignatureAsync(TestFile);
+
+		string audioSignature = await task.ConfigureAwait(false);
+
+		Assert.That(audioSignature, Is.EqualTo(expected));
+	}
+
+	/// <summary>
+	/// The get audio signature asynchronously cancelled test.
+	/// </summary>
+	[Test]
+	public void AudioSignatureAsyncCancelled()
+	{
+		using CancellationTokenSource source = new ();
+		source.Cancel();
+
+		Task<string> task = AudioSignature.GetAudioSignatureAsync(
+			TestFile, null, source.Token);
+
+		Assert.ThrowsAsync<TaskCanceledException>(async () =>
+			await task.ConfigureAwait(false));
+	}
+
+	/// <summary>
+	/// The get audio signature asynchronously timed out test.
+	/// </summary>
+	[Test]
+	public void AudioSignatureAsyncTimeout()
+	{
+		SignatureOptions options = new ();
+		options.Timeout = TimeSpan.FromTicks(1);
+
+		Task<string> task =
+			AudioSignature.GetAudioSignatureAsync(TestFile, options);
+
+		Assert.ThrowsAsync<TimeoutException>(async () =>
+			await task.ConfigureAwait(false));
+	}
+
+	/// <summary>
+	/// The get audio signatures batch test.
+	/// </summary>
+	[Test]
+	public void AudioSignaturesBatch()
+	{
+		string expected = AudioSignature.GetAudioSignature(TestFile);
+		string missingFile = Path.Combine(TemporaryPath, "Missing.mp4");
+
+		string[] audioSignatures = AudioSignature.GetAudioSignatures(
+			[TestFile, missingFile, TestFile]);
+
+		Assert.That(audioSignatures, Has.Length.EqualTo(3));
+		Assert.That(audioSignatures[0], Is.EqualTo(expected));
+		Assert.That(audioSignatures[1], Is.Null);
+		Assert.That(audioSignatures[2], Is.EqualTo(expected));
+	}
+
+	/// <summary>
+	/// The try get audio signature test.
+	/// </summary>
+	[Test]
+	public void AudioSignatureTryGet()
+	{
+		string expected = AudioSignature.GetAudioSignature(TestFile);
+
+		byte[] buffer = new byte[8];
+
+		bool written = AudioSignature.TryGetAudioSignature(
+			TestFile, buffer, out int length);
+
+		Assert.That(written, Is.False);
+		Assert.That(length, Is.EqualTo(expected.Length));
+
+		// Room for the signature and its null.
+		buffer = new byte[length + 1];
+
+		written = AudioSignature.TryGetAudioSignature(
+			TestFile, buffer, out length);
+
+		Assert.That(written, Is.True);
+
+		string audioSignature = Encoding.ASCII.GetString(buffer, 0, length);
+		Assert.That(audioSignature, Is.EqualTo(expected));
+	}
+
+	/// <summary>
+	/// The transcode audio files test.
+	/// </summary>
+	[Test]
+	public void AudioTranscode()
+	{
+		string outputPath = Path.Combine(TemporaryPath, "Transcoded.flac");
+		string missingFile = Path.Combine(TemporaryPath, "Missing.mp4");
+		string missingOutput = Path.Combine(TemporaryPath, "Missing.flac");
+
+		TranscodeStatus[] statuses = AudioSignature.TranscodeAudioFiles(
+			[TestFile, missingFile], [outputPath, missingOutput]);
+
+		Assert.That(statuses, Has.Length.EqualTo(2));
+		Assert.That(statuses[0], Is.EqualTo(TranscodeStatus.Success));
+		Assert.That(statuses[1], Is.EqualTo(TranscodeStatus.Failed));
+		Assert.That(File.Exists(missingOutput), Is.False);
+
+		bool probed =
+			AudioSignature.ProbeAudioFile(outputPath, out AudioProbe probe);
+
+		Assert.That(probed, Is.True);
+		Assert.That(probe.Lossless, Is.True);
+
+		// Without overwrite, an existing output is left alone.
+		statuses = AudioSignature.TranscodeAudioFiles(
+			[TestFile], [outputPath]);
+
+		Assert.That(statuses[0], Is.EqualTo(TranscodeStatus.Failed));
+
+		// Clean up.
+		File.Delete(outputPath);
+	}
+
 	/// <summary>
 	/// The get duplicate location test.
 	/// </summary>
@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioAnalysis.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the results of analyzing a file's audio in a single
+/// decoding pass.
+/// </summary>
+public class AudioAnalysis
+{
+	private readonly AudioAnalysisTypes completed;
+	private readonly string audioSignature;
+	private readonly string contentHash;
+	private readonly string codec;
+	private readonly int sampleRate;
+	private readonly int channels;
+	private readonly int bitsPerSample;
+	private readonly long bitRate;
+	private readonly TimeSpan duration;
+	private readonly double integratedLoudness;
+	private readonly double samplePeak;
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="AudioAnalysis"/> class.
+	/// </summary>
+	/// <param name="result">The native results.</param>
+	internal AudioAnalysis(AudioAnalysisResult result)
+	{
+		completed = (AudioAnalysisTypes)result.Completed;
+		audioSignature = Marshal.PtrToStringAnsi(result.AudioSignature);
+
+		if (completed.HasFlag(AudioAnalysisTypes.ContentHash))
+		{
+			contentHash = result.ContentHash;
+		}
+
+		if (completed.HasFlag(AudioAnalysisTypes.Properties))
+		{
+			codec = result.Codec;
+		}
+
+		sampleRate = result.SampleRate;
+		channels = result.Channels;
+		bitsPerSample = result.BitsPerSample;
+		bitRate = result.BitRate;
+		duration = TimeSpan.FromSeconds(result.Duration);
+		integratedLoudness = result.IntegratedLoudness;
+		samplePeak = result.SamplePeak;
+	}
+
+	/// <summary>
+	/// Gets the analyses that completed.
+	/// </summary>
+	/// <value>The analyses that completed.</value>
+	public AudioAnalysisTypes Completed
+	{
+		get { return completed; }
+	}
+
+	/// <summary>
+	/// Gets the audio signature.
+	/// </summary>
+	/// <value>The audio signature, or null.</value>
+	public string AudioSignature
+	{
+		get { return audioSignature; }
+	}
+
+	/// <summary>
+	/// Gets the SHA-256 of the decoded samples, in lower case hex.
+	/// </summary>
+	/// <value>The content hash, or null.</value>
+	public string ContentHash
+	{
+		get { return contentHash; }
+	}
+
+	/// <summary>
+	/// Gets the FFmpeg name of the codec.
+	/// </summary>
+	/// <value>The codec name, or null.</value>
+	public string Codec
+	{
+		get { return codec; }
+	}
+
+	/// <summary>
+	/// Gets the sample rate.
+	/// </summary>
+	/// <value>The sample rate.</value>
+	public int SampleRate
+	{
+		get { return sampleRate; }
+	}
+
+	/// <summary>
+	/// Gets the number of channels.
+	/// </summary>
+	/// <value>The number of channels.</value>
+	public int Channels
+	{
+		get { return channels; }
+	}
+
+	/// <summary>
+	/// Gets the bit depth of the source audio.
+	/// </summary>
+	/// <value>The bits per sample.</value>
+	public int BitsPerSample
+	{
+		get { return bitsPerSample; }
+	}
+
+	/// <summary>
+	/// Gets the bit rate, in bits per second.
+	/// </summary>
+	/// <value>The bit rate, or zero if the file does not record it.
+	/// </value>
+	public long BitRate
+	{
+		get { return bitRate; }
+	}
+
+	/// <summary>
+	/// Gets the length of the audio decoded.
+	/// </summary>
+	/// <value>The duration.</value>
+	public TimeSpan Duration
+	{
+		get { return duration; }
+	}
+
+	/// <summary>
+	/// Gets the EBU R128 integrated loudness.
+	/// </summary>
+	/// <value>The loudness in LUFS, or negative infinity for silence.
+	/// </value>
+	public double IntegratedLoudness
+	{
+		get { return integratedLoudness; }
+	}
+
+	/// <summary>
+	/// Gets the largest absolute sample.
+	/// </summary>
+	/// <value>The sample peak, at full scale of one.</value>
+	public double SamplePeak
+	{
+		get { return samplePeak; }
+	}
+}
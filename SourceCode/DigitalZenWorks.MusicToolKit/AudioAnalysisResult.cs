@@ -0,0 +1,37 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioAnalysisResult.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the native results of analyzing a file.
+/// </summary>
+/// <remarks>The field layout must match the native AudioAnalysis
+/// structure.  The signature must be freed with FreeAudioAnalysis.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+internal struct AudioAnalysisResult
+{
+	public int Completed;
+	public IntPtr AudioSignature;
+
+	[MarshalAs(UnmanagedType.ByValTStr, SizeConst = 65)]
+	public string ContentHash;
+
+	[MarshalAs(UnmanagedType.ByValTStr, SizeConst = 32)]
+	public string Codec;
+
+	public int SampleRate;
+	public int Channels;
+	public int BitsPerSample;
+	public long BitRate;
+	public double Duration;
+	public double IntegratedLoudness;
+	public double SamplePeak;
+}
@@ -0,0 +1,46 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioAnalysisTypes.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+
+/// <summary>
+/// The analyses to run over a file's audio in a single decoding pass.
+/// </summary>
+[Flags]
+public enum AudioAnalysisTypes
+{
+	/// <summary>
+	/// No analyses.
+	/// </summary>
+	None = 0,
+
+	/// <summary>
+	/// The audio signature.
+	/// </summary>
+	Signature = 1,
+
+	/// <summary>
+	/// The hash of the decoded samples.
+	/// </summary>
+	ContentHash = 2,
+
+	/// <summary>
+	/// The EBU R128 integrated loudness and the sample peak.
+	/// </summary>
+	Loudness = 4,
+
+	/// <summary>
+	/// The codec, format, bit rate and decoded duration.
+	/// </summary>
+	Properties = 8,
+
+	/// <summary>
+	/// All of the analyses.
+	/// </summary>
+	All = 15
+}
@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioContentComparison.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the result of comparing the audio content of two files.
+/// </summary>
+/// <remarks>The field layout must match the native
+/// AudioContentComparison structure.</remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct AudioContentComparison
+{
+	private int identical;
+	private long mismatchOffset;
+	private int formatDifferences;
+
+	/// <summary>
+	/// Gets a value indicating whether the decoded audio is the same.
+	/// </summary>
+	/// <value>A value indicating whether the audio is the same.</value>
+	public readonly bool Identical
+	{
+		get { return identical != 0; }
+	}
+
+	/// <summary>
+	/// Gets the first sample frame at which the audio differs, or -1 if
+	/// identical.
+	/// </summary>
+	/// <value>The mismatch offset.</value>
+	public readonly long MismatchOffset
+	{
+		get { return mismatchOffset; }
+	}
+
+	/// <summary>
+	/// Gets the ways in which the audio formats differ.
+	/// </summary>
+	/// <value>The format differences.</value>
+	public readonly AudioFormatDifferences FormatDifferences
+	{
+		get { return (AudioFormatDifferences)formatDifferences; }
+	}
+}
@@ -0,0 +1,41 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioFormatDifferences.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+
+/// <summary>
+/// The ways in which the audio formats of two files differ.
+/// </summary>
+[Flags]
+public enum AudioFormatDifferences
+{
+	/// <summary>
+	/// The formats are the same.
+	/// </summary>
+	None = 0,
+
+	/// <summary>
+	/// The sample rates differ.
+	/// </summary>
+	SampleRate = 1,
+
+	/// <summary>
+	/// The channel counts differ.
+	/// </summary>
+	Channels = 2,
+
+	/// <summary>
+	/// The decoded sample formats differ.
+	/// </summary>
+	SampleFormat = 4,
+
+	/// <summary>
+	/// The source bit depths differ.
+	/// </summary>
+	BitsPerSample = 8
+}
@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioProbe.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the format of a file's audio, as read from its headers.
+/// </summary>
+/// <remarks>The field layout must match the native AudioProbe
+/// structure.</remarks>
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+public struct AudioProbe
+{
+	private int codecId;
+	[MarshalAs(UnmanagedType.ByValTStr, SizeConst = 32)]
+	private string codec;
+	private int lossless;
+	private int sampleRate;
+	private int bitsPerSample;
+	private int channels;
+	private double duration;
+	private long bitRate;
+
+	/// <summary>
+	/// Gets the FFmpeg codec id of the audio stream.
+	/// </summary>
+	/// <value>The codec id.</value>
+	public readonly int CodecId
+	{
+		get { return codecId; }
+	}
+
+	/// <summary>
+	/// Gets the FFmpeg name of the codec.
+	/// </summary>
+	/// <value>The codec name.</value>
+	public readonly string Codec
+	{
+		get { return codec; }
+	}
+
+	/// <summary>
+	/// Gets a value indicating whether the codec is lossless.
+	/// </summary>
+	/// <value>A value indicating whether the codec is lossless.</value>
+	public readonly bool Lossless
+	{
+		get { return lossless != 0; }
+	}
+
+	/// <summary>
+	/// Gets the sample rate.
+	/// </summary>
+	/// <value>The sample rate.</value>
+	public readonly int SampleRate
+	{
+		get { return sampleRate; }
+	}
+
+	/// <summary>
+	/// Gets the source bit depth, where the headers record it.
+	/// </summary>
+	/// <value>The bits per sample, or zero.</value>
+	public readonly int BitsPerSample
+	{
+		get { return bitsPerSample; }
+	}
+
+	/// <summary>
+	/// Gets the number of channels.
+	/// </summary>
+	/// <value>The number of channels.</value>
+	public readonly int Channels
+	{
+		get { return channels; }
+	}
+
+	/// <summary>
+	/// Gets the length of the audio.
+	/// </summary>
+	/// <value>The duration.</value>
+	public readonly TimeSpan Duration
+	{
+		get { return TimeSpan.FromSeconds(duration); }
+	}
+
+	/// <summary>
+	/// Gets the bit rate, in bits per second.
+	/// </summary>
+	/// <value>The bit rate, or zero if unknown.</value>
+	public readonly long BitRate
+	{
+		get { return bitRate; }
+	}
+}
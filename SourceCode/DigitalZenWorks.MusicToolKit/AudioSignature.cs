@@ -8,12 +8,150 @@ namespace DigitalZenWorks.MusicToolKit;
 
 using System;
 using System.Runtime.InteropServices;
+using System.Threading;
+using System.Threading.Tasks;
 
 /// <summary>
 /// Represents an audio signature.
 /// </summary>
 public static class AudioSignature
 {
+	private const int SignatureSuccess = 0;
+	private const int SignatureBufferTooSmall = 3;
+
+	// Enough for the default 120 seconds of audio, at about eight items a
+	// second, so a second decode is rarely needed.
+	private const int RawBufferSize = 2048;
+
+	// A single delegate serves every asynchronous call, so there is only
+	// the one to keep alive while native code holds it.
+	private static readonly SignatureCallback SignatureCompleted =
+		OnSignatureCompleted;
+
+	/// <summary>
+	/// Analyze the audio of a file in a single decoding pass.
+	/// </summary>
+	/// <remarks>The file is decoded once for all of the analyses, rather
+	/// than once for each of the calls that would otherwise be needed.
+	/// </remarks>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="analyses">The analyses to run.</param>
+	/// <param name="options">The signature options, or null for the
+	/// defaults.</param>
+	/// <returns>The results, or null if the file could not be read.
+	/// </returns>
+	public static AudioAnalysis AnalyzeAudioFile(
+		string filePath,
+		AudioAnalysisTypes analyses = AudioAnalysisTypes.All,
+		SignatureOptions options = null)
+	{
+		ArgumentException.ThrowIfNullOrEmpty(filePath);
+
+		AudioAnalysis analysis = null;
+
+		int status = NativeMethods.AnalyzeAudioFile(
+			filePath, options, (int)analyses, out AudioAnalysisResult result);
+
+		if (status == SignatureSuccess)
+		{
+			analysis = new (result);
+
+			NativeMethods.FreeAudioAnalysis(ref result);
+		}
+
+		return analysis;
+	}
+
+	/// <summary>
+	/// Close the signature cache, saving the signatures taken since it was
+	/// opened.
+	/// </summary>
+	/// <returns>A value indicating whether the cache was saved.</returns>
+	public static bool CloseCache()
+	{
+		int status = NativeMethods.CloseSignatureCache();
+
+		return status == SignatureSuccess;
+	}
+
+	/// <summary>
+	/// Compare the decoded audio of two files.
+	/// </summary>
+	/// <remarks>The files are decoded together, and the comparison stops
+	/// at the first difference.</remarks>
+	/// <param name="firstPath">The first file path.</param>
+	/// <param name="secondPath">The second file path.</param>
+	/// <param name="comparison">The comparison result.</param>
+	/// <returns>A value indicating whether both files could be decoded
+	/// and compared.</returns>
+	public static bool CompareAudioContent(
+		string firstPath,
+		string secondPath,
+		out AudioContentComparison comparison)
+	{
+		int status = NativeMethods.CompareAudioContent(
+			firstPath, secondPath, out comparison);
+
+		return status == SignatureSuccess;
+	}
+
+	/// <summary>
+	/// Compare two raw audio signatures.
+	/// </summary>
+	/// <param name="first">The first raw audio signature.</param>
+	/// <param name="second">The second raw audio signature.</param>
+	/// <param name="maxOffset">The maximum number of items to shift the
+	/// signatures against each other.</param>
+	/// <param name="bestOffset">The offset of the second signature into
+	/// the first at the best alignment.</param>
+	/// <returns>The bit error rate at the best alignment, from 0 for
+	/// identical audio to about 0.5 for unrelated audio, or 1 if the
+	/// signatures could not be compared.</returns>
+	public static double CompareAudioSignatures(
+		uint[] first, uint[] second, int maxOffset, out int bestOffset)
+	{
+		ArgumentNullException.ThrowIfNull(first);
+		ArgumentNullException.ThrowIfNull(second);
+
+		int status = NativeMethods.CompareAudioSignatures(
+			first,
+			(UIntPtr)first.Length,
+			second,
+			(UIntPtr)second.Length,
+			maxOffset,
+			out double bitErrorRate,
+			out bestOffset);
+
+		if (status != SignatureSuccess)
+		{
+			bitErrorRate = 1.0;
+		}
+
+		return bitErrorRate;
+	}
+
+	/// <summary>
+	/// Get the hash of the decoded audio content.
+	/// </summary>
+	/// <remarks>Two files with the same hash have the same audio, whatever
+	/// their container, codec or metadata.</remarks>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="normalize">Whether to convert the audio to 44.1 kHz,
+	/// 16 bit stereo before hashing, so that files differing only in
+	/// format can match.</param>
+	/// <returns>The SHA-256 of the audio samples, in hex, or null if the
+	/// file could not be decoded.</returns>
+	public static string GetAudioContentHash(
+		string filePath, bool normalize = false)
+	{
+		IntPtr data = NativeMethods.GetAudioContentHash(filePath, normalize);
+		string contentHash = Marshal.PtrToStringAnsi(data);
+
+		NativeMethods.FreeAudioSignature(data);
+
+		return contentHash;
+	}
+
 	/// <summary>
 	/// Get audio signature.
 	/// </summary>
@@ -28,4 +166,358 @@ public static string GetAudioSignature(string filePath)
 
 		return audioSignature;
 	}
+
+	/// <summary>
+	/// Get audio signature with options.
+	/// </summary>
+	/// <remarks>A short maximum duration makes for a quick first pass over
+	/// a library, with a full pass only over the likely candidates.
+	/// </remarks>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="options">The signature options.</param>
+	/// <returns>The audio signature.</returns>
+	public static string GetAudioSignature(
+		string filePath, SignatureOptions options)
+	{
+		ArgumentNullException.ThrowIfNull(options);
+
+		IntPtr data =
+			NativeMethods.GetAudioSignatureWithOptions(filePath, options);
+		string audioSignature = Marshal.PtrToStringAnsi(data);
+
+		NativeMethods.FreeAudioSignature(data);
+
+		return audioSignature;
+	}
+
+	/// <summary>
+	/// Get audio signature asynchronously.
+	/// </summary>
+	/// <remarks>The file is decoded on the native library's own pool of
+	/// threads, so no managed thread is blocked while it waits, and any
+	/// number of calls can be outstanding.  The task fails with a
+	/// <see cref="TimeoutException"/> if the file takes longer than the
+	/// options' timeout.</remarks>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="options">The signature options, or null for the
+	/// defaults.</param>
+	/// <param name="cancellationToken">The token to stop the decoding
+	/// with.</param>
+	/// <returns>A task giving the audio signature, or null if the file
+	/// could not be processed.</returns>
+	public static Task<string> GetAudioSignatureAsync(
+		string filePath,
+		SignatureOptions options = null,
+		CancellationToken cancellationToken = default)
+	{
+		ArgumentException.ThrowIfNullOrEmpty(filePath);
+
+		PendingSignature pending = new (cancellationToken);
+
+		SignatureOptions callOptions =
+			options?.Clone() ?? new SignatureOptions();
+		callOptions.Cancellation = pending.Cancellation;
+
+		GCHandle handle = GCHandle.Alloc(pending);
+
+		int status = NativeMethods.GetAudioSignatureAsync(
+			filePath,
+			callOptions,
+			SignatureCompleted,
+			GCHandle.ToIntPtr(handle));
+
+		if (status != SignatureSuccess)
+		{
+			handle.Free();
+			pending.Complete(status, null);
+
+			throw new ArgumentException(
+				"The signature options are not valid.", nameof(options));
+		}
+
+		return pending.Task;
+	}
+
+	/// <summary>
+	/// Get audio signatures for a batch of files.
+	/// </summary>
+	/// <remarks>The whole batch is processed natively on a pool of worker
+	/// threads, with a single interop call, and its results come back in
+	/// one block, freed with a single call.</remarks>
+	/// <param name="filePaths">The file paths of the audio files.</param>
+	/// <param name="threadCount">The number of worker threads, or zero to
+	/// use the processor count.</param>
+	/// <returns>The audio signatures, in the same order as the file paths.
+	/// Files that could not be processed have a null entry.</returns>
+	public static string[] GetAudioSignatures(
+		string[] filePaths, int threadCount = 0)
+	{
+		ArgumentNullException.ThrowIfNull(filePaths);
+
+		string[] audioSignatures = new string[filePaths.Length];
+
+		NativeMethods.GetAudioSignatureBatch(
+			filePaths,
+			(UIntPtr)filePaths.Length,
+			threadCount,
+			out IntPtr results);
+
+		if (results != IntPtr.Zero)
+		{
+			for (int index = 0; index < filePaths.Length; index++)
+			{
+				IntPtr data =
+					Marshal.ReadIntPtr(results, index * IntPtr.Size);
+
+				audioSignatures[index] = Marshal.PtrToStringAnsi(data);
+			}
+
+			NativeMethods.FreeAudioSignatureBatch(results);
+		}
+
+		return audioSignatures;
+	}
+
+	/// <summary>
+	/// Get the raw audio signature.
+	/// </summary>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="algorithm">The fingerprint algorithm used.</param>
+	/// <returns>The raw audio signature, or null on failure.</returns>
+	public static uint[] GetRawAudioSignature(
+		string filePath, out int algorithm)
+	{
+		uint[] buffer = new uint[RawBufferSize];
+
+		int status = NativeMethods.GetRawAudioSignature(
+			filePath,
+			buffer,
+			(UIntPtr)buffer.Length,
+			out UIntPtr length,
+			out algorithm);
+
+		if (status == SignatureBufferTooSmall)
+		{
+			buffer = new uint[(int)length];
+
+			status = NativeMethods.GetRawAudioSignature(
+				filePath,
+				buffer,
+				(UIntPtr)buffer.Length,
+				out length,
+				out algorithm);
+		}
+
+		uint[] rawSignature = null;
+
+		if (status == SignatureSuccess)
+		{
+			rawSignature = buffer[..(int)length];
+		}
+
+		return rawSignature;
+	}
+
+	/// <summary>
+	/// Get the time spent in each stage of fingerprinting.
+	/// </summary>
+	/// <returns>The stage times of every file fingerprinted since the
+	/// library was loaded, or the stats were last reset, one entry per
+	/// codec.</returns>
+	public static SignatureStats[] GetStats()
+	{
+		SignatureStats[] stats = [];
+		int status = SignatureBufferTooSmall;
+
+		// Another thread may add a codec between the calls, so the buffer
+		// is grown until it fits.
+		while (status == SignatureBufferTooSmall)
+		{
+			status = NativeMethods.GetAudioSignatureStats(
+				stats, (UIntPtr)stats.Length, out UIntPtr count);
+
+			if (status == SignatureBufferTooSmall)
+			{
+				stats = new SignatureStats[(int)count];
+			}
+			else if (status == SignatureSuccess)
+			{
+				stats = stats[..(int)count];
+			}
+		}
+
+		return stats;
+	}
+
+	/// <summary>
+	/// Open the signature cache.
+	/// </summary>
+	/// <remarks>While the cache is open, signatures of files unchanged
+	/// since they were cached are returned without decoding the audio.
+	/// </remarks>
+	/// <param name="cachePath">The cache file path.  The file is created
+	/// on close if it does not exist.</param>
+	/// <returns>A value indicating whether any previously open cache was
+	/// saved.</returns>
+	public static bool OpenCache(string cachePath)
+	{
+		ArgumentException.ThrowIfNullOrEmpty(cachePath);
+
+		int status = NativeMethods.OpenSignatureCache(cachePath);
+
+		return status == SignatureSuccess;
+	}
+
+	/// <summary>
+	/// Read the format of a file's audio from its headers.
+	/// </summary>
+	/// <remarks>Nothing is decoded, so this is far quicker than opening
+	/// the file with a decoder, and suits sorting a library into lossy and
+	/// lossless files.</remarks>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="probe">The format of the audio.</param>
+	/// <returns>A value indicating whether the file could be read.
+	/// </returns>
+	public static bool ProbeAudioFile(string filePath, out AudioProbe probe)
+	{
+		ArgumentException.ThrowIfNullOrEmpty(filePath);
+
+		int status = NativeMethods.ProbeAudioFile(filePath, out probe);
+
+		return status == SignatureSuccess;
+	}
+
+	/// <summary>
+	/// Reset the fingerprinting stage times.
+	/// </summary>
+	public static void ResetStats()
+	{
+		NativeMethods.ResetAudioSignatureStats();
+	}
+
+	/// <summary>
+	/// Transcode audio files to another codec, several at once.
+	/// </summary>
+	/// <remarks>The files are decoded and encoded within the process,
+	/// on a pool of threads, with the tags and cover art carried across.
+	/// Each output is renamed into place only once complete.</remarks>
+	/// <param name="inputPaths">The file paths of the audio files.</param>
+	/// <param name="outputPaths">The file paths to write, one per input,
+	/// whose extensions pick the containers.</param>
+	/// <param name="options">The transcoding options, or null for the
+	/// defaults.</param>
+	/// <param name="cancellationToken">The token to stop the files not yet
+	/// finished with.</param>
+	/// <returns>The status of each file, in the same order as the file
+	/// paths.</returns>
+	public static TranscodeStatus[] TranscodeAudioFiles(
+		string[] inputPaths,
+		string[] outputPaths,
+		TranscodeOptions options = null,
+		CancellationToken cancellationToken = default)
+	{
+		ArgumentNullException.ThrowIfNull(inputPaths);
+		ArgumentNullException.ThrowIfNull(outputPaths);
+
+		if (outputPaths.Length != inputPaths.Length)
+		{
+			throw new ArgumentException(
+				"There must be one output path per input path.",
+				nameof(outputPaths));
+		}
+
+		int[] statuses = new int[inputPaths.Length];
+
+		// The cancellation is set on a copy, so that the caller's options
+		// can be shared between calls.
+		TranscodeOptions callOptions =
+			options?.Clone() ?? new TranscodeOptions();
+
+		IntPtr cancellation = IntPtr.Zero;
+
+		if (cancellationToken.CanBeCanceled)
+		{
+			cancellation = NativeMethods.CreateSignatureCancellation();
+			callOptions.Cancellation = cancellation;
+		}
+
+		try
+		{
+			using CancellationTokenRegistration registration =
+				cancellationToken.Register(
+					() => NativeMethods.CancelSignature(cancellation));
+
+			NativeMethods.TranscodeAudioFiles(
+				inputPaths,
+				outputPaths,
+				(UIntPtr)inputPaths.Length,
+				callOptions,
+				statuses);
+		}
+		finally
+		{
+			if (cancellation != IntPtr.Zero)
+			{
+				NativeMethods.DestroySignatureCancellation(cancellation);
+			}
+		}
+
+		TranscodeStatus[] results = Array.ConvertAll(
+			statuses, status => (TranscodeStatus)status);
+
+		return results;
+	}
+
+	/// <summary>
+	/// Try to get the audio signature into the caller's buffer.
+	/// </summary>
+	/// <remarks>The signature is written as null terminated ASCII, so
+	/// nothing is allocated on either side.  The buffer is pinned only
+	/// for the length of the call.</remarks>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <param name="buffer">The buffer to receive the audio signature.
+	/// </param>
+	/// <param name="length">The length of the audio signature, not
+	/// counting the null, which is also set when the buffer is too small.
+	/// </param>
+	/// <param name="options">The signature options, or null for the
+	/// defaults.</param>
+	/// <returns>A value indicating whether the audio signature was written.
+	/// </returns>
+	public static bool TryGetAudioSignature(
+		string filePath,
+		Span<byte> buffer,
+		out int length,
+		SignatureOptions options = null)
+	{
+		ArgumentException.ThrowIfNullOrEmpty(filePath);
+
+		int status = NativeMethods.GetAudioSignatureToBuffer(
+			filePath,
+			options,
+			ref MemoryMarshal.GetReference(buffer),
+			(UIntPtr)buffer.Length,
+			out UIntPtr signatureLength);
+
+		length = (int)signatureLength;
+
+		bool written = status == SignatureSuccess;
+
+		return written;
+	}
+
+	private static void OnSignatureCompleted(
+		int status, IntPtr audioSignature, IntPtr userData)
+	{
+		GCHandle handle = GCHandle.FromIntPtr(userData);
+		PendingSignature pending = (PendingSignature)handle.Target;
+
+		handle.Free();
+
+		string signature = Marshal.PtrToStringAnsi(audioSignature);
+
+		NativeMethods.FreeAudioSignature(audioSignature);
+
+		pending.Complete(status, signature);
+	}
 }
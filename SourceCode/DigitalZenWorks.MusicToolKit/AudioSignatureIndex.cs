@@ -0,0 +1,148 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioSignatureIndex.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+
+/// <summary>
+/// Represents an index of raw audio signatures, for finding duplicate
+/// candidates without comparing every pair of tracks.
+/// </summary>
+/// <remarks>Searches may run concurrently, but not while tracks are being
+/// added or removed.</remarks>
+public sealed class AudioSignatureIndex : IDisposable
+{
+	// Dropping the low bits of each item lets slightly different encodes
+	// of the same audio still share keys.
+	private const int DefaultKeyBits = 28;
+
+	private IntPtr index;
+
+	/// <summary>
+	/// Initializes a new instance of the
+	/// <see cref="AudioSignatureIndex"/> class.
+	/// </summary>
+	public AudioSignatureIndex()
+		: this(DefaultKeyBits)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the
+	/// <see cref="AudioSignatureIndex"/> class.
+	/// </summary>
+	/// <param name="keyBits">The number of high bits of each raw
+	/// signature item to index on, from 1 to 32.</param>
+	public AudioSignatureIndex(int keyBits)
+	{
+		ArgumentOutOfRangeException.ThrowIfLessThan(keyBits, 1);
+		ArgumentOutOfRangeException.ThrowIfGreaterThan(keyBits, 32);
+
+		index = NativeMethods.CreateFingerprintIndex(keyBits);
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="AudioSignatureIndex"/>
+	/// class.
+	/// </summary>
+	~AudioSignatureIndex()
+	{
+		ReleaseIndex();
+	}
+
+	/// <summary>
+	/// Add a track.
+	/// </summary>
+	/// <remarks>Adding a track id already in the index replaces its
+	/// signature, as when a changed file is scanned again.</remarks>
+	/// <param name="trackId">The track id.</param>
+	/// <param name="signature">The raw audio signature of the track.
+	/// </param>
+	/// <returns>A value indicating whether the track was added.</returns>
+	public bool Add(uint trackId, uint[] signature)
+	{
+		ArgumentNullException.ThrowIfNull(signature);
+		ObjectDisposedException.ThrowIf(index == IntPtr.Zero, this);
+
+		int status = NativeMethods.FingerprintIndexAdd(
+			index, trackId, signature, (UIntPtr)signature.Length);
+
+		return status == 0;
+	}
+
+	/// <summary>
+	/// Dispose.
+	/// </summary>
+	public void Dispose()
+	{
+		ReleaseIndex();
+		GC.SuppressFinalize(this);
+	}
+
+	/// <summary>
+	/// Remove a track.
+	/// </summary>
+	/// <param name="trackId">The track id.</param>
+	/// <returns>A value indicating whether the track was in the index.
+	/// </returns>
+	public bool Remove(uint trackId)
+	{
+		ObjectDisposedException.ThrowIf(index == IntPtr.Zero, this);
+
+		int status = NativeMethods.FingerprintIndexRemove(index, trackId);
+
+		return status == 0;
+	}
+
+	/// <summary>
+	/// Search for tracks matching a signature.
+	/// </summary>
+	/// <param name="signature">The raw audio signature to search for.
+	/// </param>
+	/// <param name="minimumMatches">The minimum number of aligned items a
+	/// track must share with the signature.</param>
+	/// <param name="maximumResults">The maximum number of tracks to
+	/// return.</param>
+	/// <returns>The matching tracks, best first, with equally good tracks
+	/// in order of track id.</returns>
+	public FingerprintMatch[] Search(
+		uint[] signature, uint minimumMatches, int maximumResults)
+	{
+		ArgumentNullException.ThrowIfNull(signature);
+		ArgumentOutOfRangeException.ThrowIfNegative(maximumResults);
+		ObjectDisposedException.ThrowIf(index == IntPtr.Zero, this);
+
+		FingerprintMatch[] matches = new FingerprintMatch[maximumResults];
+
+		int status = NativeMethods.FingerprintIndexSearch(
+			index,
+			signature,
+			(UIntPtr)signature.Length,
+			minimumMatches,
+			matches,
+			(UIntPtr)matches.Length,
+			out UIntPtr count);
+
+		if (status != 0)
+		{
+			count = UIntPtr.Zero;
+		}
+
+		Array.Resize(ref matches, (int)count);
+
+		return matches;
+	}
+
+	private void ReleaseIndex()
+	{
+		if (index != IntPtr.Zero)
+		{
+			NativeMethods.DestroyFingerprintIndex(index);
+			index = IntPtr.Zero;
+		}
+	}
+}
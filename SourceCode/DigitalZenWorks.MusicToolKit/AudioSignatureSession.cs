@@ -0,0 +1,74 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioSignatureSession.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents a reusable audio signature session.
+/// </summary>
+/// <remarks>The native fingerprinting state is kept alive between files,
+/// so that scanning many files does not pay the setup cost for each one.
+/// An instance must only be used by one thread at a time.</remarks>
+public sealed class AudioSignatureSession : IDisposable
+{
+	private IntPtr session;
+
+	/// <summary>
+	/// Initializes a new instance of the
+	/// <see cref="AudioSignatureSession"/> class.
+	/// </summary>
+	public AudioSignatureSession()
+	{
+		session = NativeMethods.CreateSignatureSession();
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="AudioSignatureSession"/>
+	/// class.
+	/// </summary>
+	~AudioSignatureSession()
+	{
+		ReleaseSession();
+	}
+
+	/// <summary>
+	/// Dispose.
+	/// </summary>
+	public void Dispose()
+	{
+		ReleaseSession();
+		GC.SuppressFinalize(this);
+	}
+
+	/// <summary>
+	/// Get audio signature.
+	/// </summary>
+	/// <param name="filePath">The file path of the audio file.</param>
+	/// <returns>The audio signature.</returns>
+	public string GetAudioSignature(string filePath)
+	{
+		ObjectDisposedException.ThrowIf(session == IntPtr.Zero, this);
+
+		IntPtr data = NativeMethods.SignatureSessionRun(session, filePath);
+		string audioSignature = Marshal.PtrToStringAnsi(data);
+
+		NativeMethods.FreeAudioSignature(data);
+
+		return audioSignature;
+	}
+
+	private void ReleaseSession()
+	{
+		if (session != IntPtr.Zero)
+		{
+			NativeMethods.DestroySignatureSession(session);
+			session = IntPtr.Zero;
+		}
+	}
+}
@@ -0,0 +1,112 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="AudioSignatureConsumer.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit.Decoders;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents an audio consumer that builds an audio signature.
+/// </summary>
+/// <remarks>The audio is fingerprinted as it is decoded, so audio already
+/// decoded for another purpose does not need to be decoded again.
+/// </remarks>
+public sealed class AudioSignatureConsumer : IAudioConsumer, IDisposable
+{
+	private const int SignatureSuccess = 0;
+
+	private IntPtr stream;
+
+	/// <summary>
+	/// Initializes a new instance of the
+	/// <see cref="AudioSignatureConsumer"/> class.
+	/// </summary>
+	/// <param name="sampleRate">The sample rate of the audio.</param>
+	/// <param name="channels">The number of channels of the audio.</param>
+	public AudioSignatureConsumer(int sampleRate, int channels)
+	{
+		stream = NativeMethods.SignatureStreamBegin(sampleRate, channels);
+
+		if (stream == IntPtr.Zero)
+		{
+			throw new ArgumentException(
+				"The audio format is not supported.", nameof(sampleRate));
+		}
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="AudioSignatureConsumer"/>
+	/// class.
+	/// </summary>
+	~AudioSignatureConsumer()
+	{
+		ReleaseStream();
+	}
+
+	/// <summary>
+	/// Consume audio data.
+	/// </summary>
+	/// <param name="input">The audio data.</param>
+	/// <param name="length">The number of samples to consume, no more
+	/// than the length of the audio data.</param>
+	public void Consume(short[] input, int length)
+	{
+		ArgumentNullException.ThrowIfNull(input);
+		ArgumentOutOfRangeException.ThrowIfNegative(length);
+		ArgumentOutOfRangeException.ThrowIfGreaterThan(length, input.Length);
+		ObjectDisposedException.ThrowIf(stream == IntPtr.Zero, this);
+
+		int status = NativeMethods.SignatureStreamFeed(
+			stream, input, (UIntPtr)length);
+
+		if (status != SignatureSuccess)
+		{
+			throw new InvalidOperationException(
+				"The audio could not be fingerprinted.");
+		}
+	}
+
+	/// <summary>
+	/// Dispose.
+	/// </summary>
+	public void Dispose()
+	{
+		ReleaseStream();
+		GC.SuppressFinalize(this);
+	}
+
+	/// <summary>
+	/// Get the audio signature of the consumed audio.
+	/// </summary>
+	/// <remarks>This finishes the stream, so no more audio can be consumed
+	/// afterwards.</remarks>
+	/// <returns>The audio signature.</returns>
+	public string GetAudioSignature()
+	{
+		ObjectDisposedException.ThrowIf(stream == IntPtr.Zero, this);
+
+		IntPtr data = NativeMethods.SignatureStreamFinish(stream);
+		stream = IntPtr.Zero;
+
+		string audioSignature = Marshal.PtrToStringAnsi(data);
+
+		NativeMethods.FreeAudioSignature(data);
+
+		return audioSignature;
+	}
+
+	private void ReleaseStream()
+	{
+		if (stream != IntPtr.Zero)
+		{
+			IntPtr data = NativeMethods.SignatureStreamFinish(stream);
+			stream = IntPtr.Zero;
+
+			NativeMethods.FreeAudioSignature(data);
+		}
+	}
+}
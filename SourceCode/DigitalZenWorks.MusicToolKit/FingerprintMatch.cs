@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="FingerprintMatch.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents a track found by a fingerprint index search.
+/// </summary>
+/// <remarks>The field layout must match the native FingerprintMatch
+/// structure.</remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct FingerprintMatch
+{
+	private uint trackId;
+	private uint matches;
+	private int offset;
+
+	/// <summary>
+	/// Gets the id of the matching track.
+	/// </summary>
+	/// <value>The track id.</value>
+	public readonly uint TrackId
+	{
+		get { return trackId; }
+	}
+
+	/// <summary>
+	/// Gets the number of signature items matching at the best alignment.
+	/// </summary>
+	/// <value>The number of matches.</value>
+	public readonly uint Matches
+	{
+		get { return matches; }
+	}
+
+	/// <summary>
+	/// Gets the position in the track's signature of the start of the
+	/// query, at the best alignment.
+	/// </summary>
+	/// <value>The offset.</value>
+	public readonly int Offset
+	{
+		get { return offset; }
+	}
+}
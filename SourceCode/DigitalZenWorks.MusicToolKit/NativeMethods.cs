@@ -19,6 +19,24 @@ namespace DigitalZenWorks.MusicToolKit;
 [SuppressUnmanagedCodeSecurity]
 internal static class NativeMethods
 {
+	/// <summary>
+	/// Get the hash of the decoded audio content.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="normalize">Whether to convert the audio to 44.1 kHz,
+	/// 16 bit stereo before hashing.</param>
+	/// <returns>The content hash.</returns>
+	/// <remarks>Caller must free the returned pointer using
+	/// FreeAudioSignature.</remarks>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetAudioContentHash")]
+	public static extern IntPtr GetAudioContentHash(
+		string filePath, [MarshalAs(UnmanagedType.U1)] bool normalize);
+
 	/// <summary>
 	/// Get audio signature.
 	/// </summary>
@@ -34,6 +52,339 @@ internal static class NativeMethods
 		EntryPoint = "GetAudioSignature")]
 	public static extern IntPtr GetAudioSignature(string filePath);
 
+	/// <summary>
+	/// Queue a file to have its audio signature taken on the native pool of
+	/// threads.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="options">The signature options, or null for the
+	/// defaults.</param>
+	/// <param name="callback">The callback to receive the audio signature.
+	/// It must be kept alive until called.</param>
+	/// <param name="userData">The value to pass to the callback.</param>
+	/// <returns>The status code.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetAudioSignatureAsync")]
+	public static extern int GetAudioSignatureAsync(
+		string filePath,
+		SignatureOptions options,
+		SignatureCallback callback,
+		IntPtr userData);
+
+	/// <summary>
+	/// Get audio signatures for a batch of files, returned in a single
+	/// block.
+	/// </summary>
+	/// <param name="filePaths">The file paths.</param>
+	/// <param name="count">The number of file paths.</param>
+	/// <param name="threadCount">The number of worker threads, or zero to
+	/// use the processor count.</param>
+	/// <param name="results">The array of signature pointers, in the same
+	/// order as the file paths.</param>
+	/// <returns>The number of files successfully processed.</returns>
+	/// <remarks>Caller must free the returned block using
+	/// FreeAudioSignatureBatch.</remarks>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetAudioSignatureBatch")]
+	public static extern int GetAudioSignatureBatch(
+		string[] filePaths,
+		UIntPtr count,
+		int threadCount,
+		out IntPtr results);
+
+	/// <summary>
+	/// Get audio signature into the caller's buffer.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="options">The signature options, or null for the
+	/// defaults.</param>
+	/// <param name="buffer">The first byte of the buffer to receive the
+	/// null terminated audio signature.</param>
+	/// <param name="bufferSize">The size of the buffer, in bytes.</param>
+	/// <param name="length">The length of the audio signature, not
+	/// counting the null.</param>
+	/// <returns>The status code.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetAudioSignatureToBuffer")]
+	public static extern int GetAudioSignatureToBuffer(
+		string filePath,
+		SignatureOptions options,
+		ref byte buffer,
+		UIntPtr bufferSize,
+		out UIntPtr length);
+
+	/// <summary>
+	/// Get audio signature with options.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="options">The signature options.</param>
+	/// <returns>The audio signature.</returns>
+	/// <remarks>Caller must free the returned pointer using
+	/// FreeAudioSignature.</remarks>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetAudioSignatureWithOptions")]
+	public static extern IntPtr GetAudioSignatureWithOptions(
+		string filePath, SignatureOptions options);
+
+	/// <summary>
+	/// Get audio signatures for a batch of files.
+	/// </summary>
+	/// <param name="filePaths">The file paths.</param>
+	/// <param name="count">The number of file paths.</param>
+	/// <param name="results">The array to receive the signature pointers,
+	/// in the same order as the file paths.</param>
+	/// <param name="threadCount">The number of worker threads, or zero to
+	/// use the processor count.</param>
+	/// <returns>The number of files successfully processed.</returns>
+	/// <remarks>Caller must free each returned pointer using
+	/// FreeAudioSignature.</remarks>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetAudioSignatures")]
+	public static extern int GetAudioSignatures(
+		string[] filePaths,
+		UIntPtr count,
+		[Out] IntPtr[] results,
+		int threadCount);
+
+	/// <summary>
+	/// Analyze the audio of a file in a single decoding pass.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="options">The signature options, or null for the
+	/// defaults.</param>
+	/// <param name="analyses">The AudioAnalysisTypes flags of the analyses
+	/// to run.</param>
+	/// <param name="analysis">The results.</param>
+	/// <returns>The status code.</returns>
+	/// <remarks>Caller must free the results using FreeAudioAnalysis.
+	/// </remarks>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "AnalyzeAudioFile")]
+	public static extern int AnalyzeAudioFile(
+		string filePath,
+		SignatureOptions options,
+		int analyses,
+		out AudioAnalysisResult analysis);
+
+	/// <summary>
+	/// Cancel the calls using a cancellation.
+	/// </summary>
+	/// <param name="cancellation">The cancellation.</param>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "CancelSignature")]
+	public static extern void CancelSignature(IntPtr cancellation);
+
+	/// <summary>
+	/// Close the signature cache, saving any new signatures.
+	/// </summary>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "CloseSignatureCache")]
+	public static extern int CloseSignatureCache();
+
+	/// <summary>
+	/// Compare the decoded audio of two files.
+	/// </summary>
+	/// <param name="firstPath">The first file path.</param>
+	/// <param name="secondPath">The second file path.</param>
+	/// <param name="comparison">The comparison result.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "CompareAudioContent")]
+	public static extern int CompareAudioContent(
+		string firstPath,
+		string secondPath,
+		out AudioContentComparison comparison);
+
+	/// <summary>
+	/// Compare two raw audio signatures.
+	/// </summary>
+	/// <param name="first">The first raw audio signature.</param>
+	/// <param name="firstLength">The length of the first signature.</param>
+	/// <param name="second">The second raw audio signature.</param>
+	/// <param name="secondLength">The length of the second signature.
+	/// </param>
+	/// <param name="maxOffset">The maximum alignment offset to try.</param>
+	/// <param name="bitErrorRate">The lowest bit error rate found.</param>
+	/// <param name="bestOffset">The offset giving that rate.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "CompareAudioSignatures")]
+	public static extern int CompareAudioSignatures(
+		uint[] first,
+		UIntPtr firstLength,
+		uint[] second,
+		UIntPtr secondLength,
+		int maxOffset,
+		out double bitErrorRate,
+		out int bestOffset);
+
+	/// <summary>
+	/// Create a fingerprint index.
+	/// </summary>
+	/// <param name="keyBits">The number of high bits of each raw signature
+	/// item to index on.</param>
+	/// <returns>The index handle.</returns>
+	/// <remarks>Caller must release the index using
+	/// DestroyFingerprintIndex.</remarks>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "CreateFingerprintIndex")]
+	public static extern IntPtr CreateFingerprintIndex(int keyBits);
+
+	/// <summary>
+	/// Create a cancellation.
+	/// </summary>
+	/// <returns>The cancellation.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "CreateSignatureCancellation")]
+	public static extern IntPtr CreateSignatureCancellation();
+
+	/// <summary>
+	/// Create a signature session.
+	/// </summary>
+	/// <returns>The session handle.</returns>
+	/// <remarks>Caller must release the session using
+	/// DestroySignatureSession.</remarks>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "CreateSignatureSession")]
+	public static extern IntPtr CreateSignatureSession();
+
+	/// <summary>
+	/// Destroy a fingerprint index.
+	/// </summary>
+	/// <param name="index">The index handle.</param>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "DestroyFingerprintIndex")]
+	public static extern void DestroyFingerprintIndex(IntPtr index);
+
+	/// <summary>
+	/// Destroy a cancellation.
+	/// </summary>
+	/// <param name="cancellation">The cancellation.</param>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "DestroySignatureCancellation")]
+	public static extern void DestroySignatureCancellation(
+		IntPtr cancellation);
+
+	/// <summary>
+	/// Destroy a signature session.
+	/// </summary>
+	/// <param name="session">The session handle.</param>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "DestroySignatureSession")]
+	public static extern void DestroySignatureSession(IntPtr session);
+
+	/// <summary>
+	/// Add a raw audio signature to a fingerprint index.
+	/// </summary>
+	/// <param name="index">The index handle.</param>
+	/// <param name="trackId">The track id.</param>
+	/// <param name="fingerprint">The raw audio signature.</param>
+	/// <param name="length">The length of the signature.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "FingerprintIndexAdd")]
+	public static extern int FingerprintIndexAdd(
+		IntPtr index, uint trackId, uint[] fingerprint, UIntPtr length);
+
+	/// <summary>
+	/// Remove a track from a fingerprint index.
+	/// </summary>
+	/// <param name="index">The index handle.</param>
+	/// <param name="trackId">The track id.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "FingerprintIndexRemove")]
+	public static extern int FingerprintIndexRemove(
+		IntPtr index, uint trackId);
+
+	/// <summary>
+	/// Search a fingerprint index for tracks matching a raw audio
+	/// signature.
+	/// </summary>
+	/// <param name="index">The index handle.</param>
+	/// <param name="fingerprint">The raw audio signature.</param>
+	/// <param name="length">The length of the signature.</param>
+	/// <param name="minimumMatches">The minimum number of aligned items.
+	/// </param>
+	/// <param name="matches">The buffer to receive the matches.</param>
+	/// <param name="matchesSize">The size of the matches buffer.</param>
+	/// <param name="count">The number of matches written.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "FingerprintIndexSearch")]
+	public static extern int FingerprintIndexSearch(
+		IntPtr index,
+		uint[] fingerprint,
+		UIntPtr length,
+		uint minimumMatches,
+		[Out] FingerprintMatch[] matches,
+		UIntPtr matchesSize,
+		out UIntPtr count);
+
+	/// <summary>
+	/// Free the results of analyzing a file.
+	/// </summary>
+	/// <param name="analysis">The results to free.</param>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "FreeAudioAnalysis")]
+	public static extern void FreeAudioAnalysis(
+		ref AudioAnalysisResult analysis);
+
 	/// <summary>
 	/// Free audio signature.
 	/// </summary>
@@ -43,4 +394,188 @@ internal static class NativeMethods
 		CallingConvention = CallingConvention.Cdecl,
 		EntryPoint = "FreeAudioSignature")]
 	public static extern void FreeAudioSignature(IntPtr data);
+
+	/// <summary>
+	/// Free a batch of audio signatures.
+	/// </summary>
+	/// <param name="results">The block returned by
+	/// GetAudioSignatureBatch.</param>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "FreeAudioSignatureBatch")]
+	public static extern void FreeAudioSignatureBatch(IntPtr results);
+
+	/// <summary>
+	/// Get the fingerprinting stage times, per codec.
+	/// </summary>
+	/// <param name="stats">The buffer to receive the stage times.</param>
+	/// <param name="statsSize">The size of the buffer.</param>
+	/// <param name="count">The number of codecs.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "GetAudioSignatureStats")]
+	public static extern int GetAudioSignatureStats(
+		[Out] SignatureStats[] stats, UIntPtr statsSize, out UIntPtr count);
+
+	/// <summary>
+	/// Get the raw audio signature.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="buffer">The buffer to receive the raw fingerprint.
+	/// </param>
+	/// <param name="bufferSize">The size of the buffer, in items.</param>
+	/// <param name="length">The length of the raw fingerprint.</param>
+	/// <param name="algorithm">The fingerprint algorithm used.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "GetRawAudioSignature")]
+	public static extern int GetRawAudioSignature(
+		string filePath,
+		[Out] uint[] buffer,
+		UIntPtr bufferSize,
+		out UIntPtr length,
+		out int algorithm);
+
+	/// <summary>
+	/// Initialize the native logging.
+	/// </summary>
+	/// <param name="level">The log level, from 0 for trace to 5 for
+	/// critical.  Any other value turns logging off.</param>
+	/// <param name="logPath">The log file path, or null for the default.
+	/// </param>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "InitializeLogging")]
+	public static extern void InitializeLogging(int level, string logPath);
+
+	/// <summary>
+	/// Read the format of a file's audio from its headers.
+	/// </summary>
+	/// <param name="filePath">The file path.</param>
+	/// <param name="probe">The format of the audio.</param>
+	/// <returns>The status code.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "ProbeAudioFile")]
+	public static extern int ProbeAudioFile(
+		string filePath, out AudioProbe probe);
+
+	/// <summary>
+	/// Open the signature cache.
+	/// </summary>
+	/// <param name="cachePath">The cache file path.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "OpenSignatureCache")]
+	public static extern int OpenSignatureCache(string cachePath);
+
+	/// <summary>
+	/// Reset the fingerprinting stage times.
+	/// </summary>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "ResetAudioSignatureStats")]
+	public static extern void ResetAudioSignatureStats();
+
+	/// <summary>
+	/// Get audio signature using an existing session.
+	/// </summary>
+	/// <param name="session">The session handle.</param>
+	/// <param name="filePath">The file path.</param>
+	/// <returns>The audio signature.</returns>
+	/// <remarks>Caller must free the returned pointer using
+	/// FreeAudioSignature.</remarks>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "SignatureSessionRun")]
+	public static extern IntPtr SignatureSessionRun(
+		IntPtr session, string filePath);
+
+	/// <summary>
+	/// Begin a signature stream.
+	/// </summary>
+	/// <param name="sampleRate">The sample rate of the audio.</param>
+	/// <param name="channels">The number of channels of the audio.</param>
+	/// <returns>The stream handle.</returns>
+	/// <remarks>Caller must release the stream using
+	/// SignatureStreamFinish.</remarks>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "SignatureStreamBegin")]
+	public static extern IntPtr SignatureStreamBegin(
+		int sampleRate, int channels);
+
+	/// <summary>
+	/// Feed audio data to a signature stream.
+	/// </summary>
+	/// <param name="stream">The stream handle.</param>
+	/// <param name="data">The interleaved 16 bit audio data.</param>
+	/// <param name="size">The number of samples to feed.</param>
+	/// <returns>The status of the call.</returns>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "SignatureStreamFeed")]
+	public static extern int SignatureStreamFeed(
+		IntPtr stream, short[] data, UIntPtr size);
+
+	/// <summary>
+	/// Finish a signature stream.
+	/// </summary>
+	/// <param name="stream">The stream handle.</param>
+	/// <returns>The audio signature.</returns>
+	/// <remarks>The stream is always released.  Caller must free the
+	/// returned pointer using FreeAudioSignature.</remarks>
+	[DllImport(
+		"AudioSignature",
+		CallingConvention = CallingConvention.Cdecl,
+		EntryPoint = "SignatureStreamFinish")]
+	public static extern IntPtr SignatureStreamFinish(IntPtr stream);
+
+	/// <summary>
+	/// Transcode audio files to another codec.
+	/// </summary>
+	/// <param name="inputPaths">The input file paths.</param>
+	/// <param name="outputPaths">The output file paths, one per input.
+	/// </param>
+	/// <param name="count">The number of file paths.</param>
+	/// <param name="options">The transcoding options, or null for the
+	/// defaults.</param>
+	/// <param name="statuses">The array to receive each file's status, in
+	/// the same order as the file paths.</param>
+	/// <returns>The number of files successfully transcoded.</returns>
+	[DllImport(
+		"AudioSignature",
+		BestFitMapping = false,
+		CallingConvention = CallingConvention.Cdecl,
+		CharSet = CharSet.Ansi,
+		EntryPoint = "TranscodeAudioFiles")]
+	public static extern int TranscodeAudioFiles(
+		string[] inputPaths,
+		string[] outputPaths,
+		UIntPtr count,
+		TranscodeOptions options,
+		[Out] int[] statuses);
 }
@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="PendingSignature.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.IO;
+using System.Threading;
+using System.Threading.Tasks;
+
+/// <summary>
+/// Represents an asynchronous native signature call still to complete.
+/// </summary>
+internal sealed class PendingSignature
+{
+	private const int SignatureTimedOut = 4;
+	private const int SignatureCancelled = 5;
+	private const int SignatureReadLimitExceeded = 6;
+
+	private readonly TaskCompletionSource<string> completion;
+	private readonly CancellationToken cancellationToken;
+	private readonly CancellationTokenRegistration registration;
+	private readonly IntPtr cancellation;
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="PendingSignature"/>
+	/// class.
+	/// </summary>
+	/// <param name="cancellationToken">The token to cancel the native call
+	/// with.</param>
+	public PendingSignature(CancellationToken cancellationToken)
+	{
+		// Continuations must not run on the native pool's threads, where
+		// they would hold up the files queued behind.
+		completion = new (TaskCreationOptions.RunContinuationsAsynchronously);
+
+		this.cancellationToken = cancellationToken;
+
+		if (cancellationToken.CanBeCanceled)
+		{
+			IntPtr nativeCancellation =
+				NativeMethods.CreateSignatureCancellation();
+
+			cancellation = nativeCancellation;
+			registration = cancellationToken.Register(
+				() => NativeMethods.CancelSignature(nativeCancellation));
+		}
+	}
+
+	/// <summary>
+	/// Gets the native cancellation, or zero if the call cannot be
+	/// cancelled.
+	/// </summary>
+	/// <value>The native cancellation.</value>
+	public IntPtr Cancellation
+	{
+		get { return cancellation; }
+	}
+
+	/// <summary>
+	/// Gets the task giving the audio signature.
+	/// </summary>
+	/// <value>The task giving the audio signature.</value>
+	public Task<string> Task
+	{
+		get { return completion.Task; }
+	}
+
+	/// <summary>
+	/// Complete the task from the native call's result.
+	/// </summary>
+	/// <param name="status">The native status code.</param>
+	/// <param name="audioSignature">The audio signature, or null on
+	/// failure.</param>
+	public void Complete(int status, string audioSignature)
+	{
+		// Disposing waits for a cancel already under way, so that the
+		// native cancellation is not destroyed beneath it.
+		registration.Dispose();
+
+		if (cancellation != IntPtr.Zero)
+		{
+			NativeMethods.DestroySignatureCancellation(cancellation);
+		}
+
+		switch (status)
+		{
+			case SignatureCancelled:
+				completion.SetCanceled(cancellationToken);
+				break;
+			case SignatureTimedOut:
+				completion.SetException(new TimeoutException(
+					"The audio signature took longer than the timeout."));
+				break;
+			case SignatureReadLimitExceeded:
+				completion.SetException(new InvalidDataException(
+					"The audio signature needed more of the file than the " +
+					"read limit."));
+				break;
+			default:
+				completion.SetResult(audioSignature);
+				break;
+		}
+	}
+}
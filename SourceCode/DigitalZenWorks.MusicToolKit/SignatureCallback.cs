@@ -0,0 +1,21 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="SignatureCallback.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Receives the result of an asynchronous native signature call.
+/// </summary>
+/// <param name="status">The status code.</param>
+/// <param name="audioSignature">The audio signature, or zero on failure,
+/// which must be freed using FreeAudioSignature.</param>
+/// <param name="userData">The value passed with the call.</param>
+[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+internal delegate void SignatureCallback(
+	int status, IntPtr audioSignature, IntPtr userData);
@@ -0,0 +1,165 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="SignatureOptions.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the audio signature options.
+/// </summary>
+/// <remarks>The field layout must match the native SignatureOptions
+/// structure.</remarks>
+[StructLayout(LayoutKind.Sequential)]
+public class SignatureOptions
+{
+	private int maxDuration = 120;
+	private int maxChunkDuration;
+	private int overlap;
+	private int algorithm = 1;
+	private double startOffset;
+	private int inputMode;
+	private int resampleMode;
+	private int decoderThreads = 1;
+	private double timeout;
+	private long maxBytesRead;
+	private IntPtr cancellation;
+
+	/// <summary>
+	/// Gets or sets the maximum number of seconds of audio to process, or
+	/// zero for the whole file.
+	/// </summary>
+	/// <value>The maximum duration.</value>
+	public int MaxDuration
+	{
+		get { return maxDuration; }
+		set { maxDuration = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the length of each chunk in seconds, or zero for none.
+	/// </summary>
+	/// <value>The maximum chunk duration.</value>
+	public int MaxChunkDuration
+	{
+		get { return maxChunkDuration; }
+		set { maxChunkDuration = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets a value indicating whether the chunks overlap.
+	/// </summary>
+	/// <value>A value indicating whether the chunks overlap.</value>
+	public bool Overlap
+	{
+		get { return overlap != 0; }
+		set { overlap = value ? 1 : 0; }
+	}
+
+	/// <summary>
+	/// Gets or sets the chromaprint algorithm.
+	/// </summary>
+	/// <value>The chromaprint algorithm.</value>
+	public int Algorithm
+	{
+		get { return algorithm; }
+		set { algorithm = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the number of seconds of audio to skip before
+	/// processing.
+	/// </summary>
+	/// <value>The start offset.</value>
+	public double StartOffset
+	{
+		get { return startOffset; }
+		set { startOffset = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets a value indicating whether the file is memory mapped,
+	/// rather than read through FFmpeg's file protocol.
+	/// </summary>
+	/// <value>A value indicating whether the file is memory mapped.
+	/// </value>
+	public bool MemoryMapped
+	{
+		get { return inputMode != 0; }
+		set { inputMode = value ? 1 : 0; }
+	}
+
+	/// <summary>
+	/// Gets or sets a value indicating whether 44.1 and 48 kHz audio is
+	/// converted with the library's own fast filter, rather than the
+	/// fpcalc compatible resampler.
+	/// </summary>
+	/// <value>A value indicating whether fast resampling is used.</value>
+	/// <remarks>The fingerprints are close to, but not always the same
+	/// as, those of fpcalc.</remarks>
+	public bool FastResampling
+	{
+		get { return resampleMode != 0; }
+		set { resampleMode = value ? 1 : 0; }
+	}
+
+	/// <summary>
+	/// Gets or sets the number of threads each file's decoder may use, for
+	/// codecs that support frame or slice threading, such as FLAC and
+	/// ALAC.
+	/// </summary>
+	/// <value>The number of decoder threads, where one decodes on the
+	/// calling thread alone, and zero lets FFmpeg pick from the processor
+	/// count.</value>
+	public int DecoderThreads
+	{
+		get { return decoderThreads; }
+		set { decoderThreads = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the most time to spend on each file, or zero for no
+	/// limit.
+	/// </summary>
+	/// <value>The timeout.</value>
+	public TimeSpan Timeout
+	{
+		get { return TimeSpan.FromSeconds(timeout); }
+		set { timeout = value.TotalSeconds; }
+	}
+
+	/// <summary>
+	/// Gets or sets the most bytes to read from each file, or zero for no
+	/// limit.
+	/// </summary>
+	/// <value>The maximum bytes read.</value>
+	public long MaxBytesRead
+	{
+		get { return maxBytesRead; }
+		set { maxBytesRead = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the native cancellation, set only on the copy passed
+	/// with a call.
+	/// </summary>
+	/// <value>The native cancellation.</value>
+	internal IntPtr Cancellation
+	{
+		get { return cancellation; }
+		set { cancellation = value; }
+	}
+
+	/// <summary>
+	/// Copy the options.
+	/// </summary>
+	/// <returns>A copy of the options.</returns>
+	internal SignatureOptions Clone()
+	{
+		return (SignatureOptions)MemberwiseClone();
+	}
+}
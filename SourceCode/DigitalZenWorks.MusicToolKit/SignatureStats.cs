@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="SignatureStats.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the time spent in each stage of fingerprinting, totalled
+/// over all files of one codec.
+/// </summary>
+/// <remarks>The field layout must match the native SignatureStats
+/// structure.</remarks>
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+public struct SignatureStats
+{
+	[MarshalAs(UnmanagedType.ByValTStr, SizeConst = 32)]
+	private string codec;
+	private ulong files;
+	private double audioSeconds;
+	private double openSeconds;
+	private double decodeSeconds;
+	private double resampleSeconds;
+	private double fingerprintSeconds;
+	private double finishSeconds;
+
+	/// <summary>
+	/// Gets the FFmpeg name of the codec.
+	/// </summary>
+	/// <value>The codec name.</value>
+	public readonly string Codec
+	{
+		get { return codec; }
+	}
+
+	/// <summary>
+	/// Gets the number of files fingerprinted.
+	/// </summary>
+	/// <value>The number of files.</value>
+	public readonly ulong Files
+	{
+		get { return files; }
+	}
+
+	/// <summary>
+	/// Gets the seconds of audio decoded.
+	/// </summary>
+	/// <value>The seconds of audio.</value>
+	public readonly double AudioSeconds
+	{
+		get { return audioSeconds; }
+	}
+
+	/// <summary>
+	/// Gets the seconds spent opening files, probing their streams and opening
+	/// their decoders.
+	/// </summary>
+	/// <value>The open seconds.</value>
+	public readonly double OpenSeconds
+	{
+		get { return openSeconds; }
+	}
+
+	/// <summary>
+	/// Gets the seconds spent reading and decoding packets, less the
+	/// resampling.
+	/// </summary>
+	/// <value>The decode seconds.</value>
+	public readonly double DecodeSeconds
+	{
+		get { return decodeSeconds; }
+	}
+
+	/// <summary>
+	/// Gets the seconds spent converting samples to the rate and channels
+	/// the fingerprinter takes.
+	/// </summary>
+	/// <value>The resample seconds.</value>
+	public readonly double ResampleSeconds
+	{
+		get { return resampleSeconds; }
+	}
+
+	/// <summary>
+	/// Gets the seconds spent processing samples in the fingerprinter.
+	/// </summary>
+	/// <value>The fingerprint seconds.</value>
+	public readonly double FingerprintSeconds
+	{
+		get { return fingerprintSeconds; }
+	}
+
+	/// <summary>
+	/// Gets the seconds spent classifying and encoding fingerprints.
+	/// </summary>
+	/// <value>The finish seconds.</value>
+	public readonly double FinishSeconds
+	{
+		get { return finishSeconds; }
+	}
+}
@@ -0,0 +1,103 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="TranscodeOptions.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+using System;
+using System.Runtime.InteropServices;
+
+/// <summary>
+/// Represents the audio transcoding options.
+/// </summary>
+/// <remarks>The field layout must match the native TranscodeOptions
+/// structure.</remarks>
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+public class TranscodeOptions
+{
+	private string encoder = "flac";
+	private long bitRate;
+	private int compressionLevel = -1;
+	private int threadCount;
+	private int overwrite;
+	private IntPtr cancellation;
+
+	/// <summary>
+	/// Gets or sets the FFmpeg name of the encoder, such as flac, alac, aac
+	/// or libmp3lame.  The container comes from each output path's
+	/// extension.
+	/// </summary>
+	/// <value>The encoder name.</value>
+	public string Encoder
+	{
+		get { return encoder; }
+		set { encoder = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the bit rate, in bits per second, for the lossy
+	/// encoders, or zero for the encoder's default.
+	/// </summary>
+	/// <value>The bit rate.</value>
+	public long BitRate
+	{
+		get { return bitRate; }
+		set { bitRate = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the encoder's compression level, such as 0 to 12 for
+	/// FLAC, or -1 for the encoder's default.
+	/// </summary>
+	/// <value>The compression level.</value>
+	public int CompressionLevel
+	{
+		get { return compressionLevel; }
+		set { compressionLevel = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets the number of files to transcode at once, or zero for
+	/// the processor count.
+	/// </summary>
+	/// <value>The thread count.</value>
+	public int ThreadCount
+	{
+		get { return threadCount; }
+		set { threadCount = value; }
+	}
+
+	/// <summary>
+	/// Gets or sets a value indicating whether existing output files are
+	/// replaced, rather than failed.
+	/// </summary>
+	/// <value>A value indicating whether existing output files are
+	/// replaced.</value>
+	public bool Overwrite
+	{
+		get { return overwrite != 0; }
+		set { overwrite = value ? 1 : 0; }
+	}
+
+	/// <summary>
+	/// Gets or sets the native cancellation, set only on the copy passed
+	/// with a call.
+	/// </summary>
+	/// <value>The native cancellation.</value>
+	internal IntPtr Cancellation
+	{
+		get { return cancellation; }
+		set { cancellation = value; }
+	}
+
+	/// <summary>
+	/// Copy the options.
+	/// </summary>
+	/// <returns>A copy of the options.</returns>
+	internal TranscodeOptions Clone()
+	{
+		return (TranscodeOptions)MemberwiseClone();
+	}
+}
@@ -0,0 +1,36 @@
+/////////////////////////////////////////////////////////////////////////////
+// <copyright file="TranscodeStatus.cs" company="Digital Zen Works">
+// Copyright © 2019 - 2026 Digital Zen Works.
+// </copyright>
+/////////////////////////////////////////////////////////////////////////////
+
+namespace DigitalZenWorks.MusicToolKit;
+
+/// <summary>
+/// The outcome of transcoding one file.
+/// </summary>
+/// <remarks>The values match the native SignatureStatus codes.</remarks>
+public enum TranscodeStatus
+{
+	/// <summary>
+	/// The file was transcoded.
+	/// </summary>
+	Success = 0,
+
+	/// <summary>
+	/// The file could not be transcoded, or the output already exists.
+	/// The reason is logged.
+	/// </summary>
+	Failed = 1,
+
+	/// <summary>
+	/// The paths or options were not valid, or another file was given the
+	/// same output path.
+	/// </summary>
+	InvalidArgument = 2,
+
+	/// <summary>
+	/// The transcoding was cancelled before the file was finished.
+	/// </summary>
+	Cancelled = 5
+}
@@ -1,54 +1,526 @@
 #define _CRT_SECURE_NO_WARNINGS
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "../AudioSignature/AudioSignature.h"
 using namespace AudioSignature;
 
+struct ScanOptions
+{
+	std::vector<std::string> paths;
+
+	// The number of worker threads, or zero for the processor count.
+	int threadCount = 0;
+
+	// The threads each decoder may use, or zero for FFmpeg's choice.
+	int decoderThreads = 1;
+
+	// The maximum number of seconds of audio to fingerprint, or zero for
+	// the whole file.
+	int maxDuration = 120;
+
+	// Fingerprint every file found, not only those with audio extensions.
+	bool allFiles = false;
+
+	// Convert 44.1 and 48 kHz audio with the fast resampler.
+	bool fastResampling = false;
+
+	// Read each file's format from its headers, instead of
+	// fingerprinting it.
+	bool probe = false;
+
+	// The most seconds to spend on each file, or zero for no limit.
+	double timeout = 0.0;
+
+	// Show where the time went, per codec, at the end.
+	bool showStats = false;
+};
+
+std::vector<std::filesystem::path> FindFiles(const ScanOptions& options);
+std::string FormatNumber(double value);
+std::string GetStatusMessage(int status);
+bool IsAudioFile(const std::filesystem::path& path);
+std::string JsonEscape(const std::string& text);
+bool ParseArguments(int argc, char** argv, ScanOptions& options);
+std::string ProbeFile(const std::string& filePath, int& status);
+size_t ScanFiles(
+	const std::vector<std::filesystem::path>& files,
+	const ScanOptions& options);
+void ShowHelp();
+void ShowStats();
+
+// Fingerprints the given files, and every audio file under the given
+// directories, writing one JSON object per line to stdout as each file
+// completes.
 int main(int argc, char** argv)
 {
-	bool minimal = true;
-	const char* dataPath = nullptr;
-	std::string tempPath;
+	int exitCode = 0;
+	ScanOptions options;
 
-	if (minimal == false)
+	if (!ParseArguments(argc, argv, options) || options.paths.empty())
 	{
-		std::cout << "Testing\n";
+		ShowHelp();
+		exitCode = 1;
 	}
+	else
+	{
+		// The library logs to stdout, which is kept for the results.
+		InitializeLogging(-1, nullptr);
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::filesystem::path> files = FindFiles(options);
+		size_t failureCount = ScanFiles(files, options);
 
-	if (argc > 1 && argv != nullptr)
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+
+		std::cerr << "Scanned " << files.size() << " files, " <<
+			failureCount << " failed, in " <<
+			FormatNumber(elapsed.count()) << " seconds" << std::endl;
+
+		if (options.showStats == true)
+		{
+			ShowStats();
+		}
+
+		if (failureCount > 0)
+		{
+			exitCode = 2;
+		}
+	}
+
+	return exitCode;
+}
+
+std::vector<std::filesystem::path> FindFiles(const ScanOptions& options)
+{
+	std::vector<std::filesystem::path> files;
+
+	for (const std::string& argument : options.paths)
 	{
-		dataPath = argv[1];
+		std::filesystem::path path = argument;
+		std::error_code error;
+
+		if (std::filesystem::is_directory(path, error))
+		{
+			auto iterator = std::filesystem::recursive_directory_iterator(
+				path,
+				std::filesystem::directory_options::skip_permission_denied,
+				error);
+
+			for (auto end = std::filesystem::recursive_directory_iterator();
+				iterator != end;
+				iterator.increment(error))
+			{
+				if (error)
+				{
+					std::cerr << "Could not read " << path << ": " <<
+						error.message() << std::endl;
+					break;
+				}
+
+				if (iterator->is_regular_file(error) &&
+					(options.allFiles == true ||
+					IsAudioFile(iterator->path())))
+				{
+					files.push_back(iterator->path());
+				}
+			}
+		}
+		else
+		{
+			// Named files are always tried, whatever their extension.
+			files.push_back(path);
+		}
 	}
-	else
+
+	// A stable order makes runs over the same tree easy to compare.
+	std::sort(files.begin(), files.end());
+
+	return files;
+}
+
+std::string FormatNumber(double value)
+{
+	char buffer[32];
+
+	snprintf(buffer, sizeof(buffer), "%.3f", value);
+
+	return buffer;
+}
+
+std::string GetStatusMessage(int status)
+{
+	std::string message = "Could not fingerprint the file";
+
+	switch (status)
 	{
-		char* appdata = std::getenv("APPDATA");
+		case SignatureTimedOut:
+			message = "Timed out";
+			break;
+		case SignatureCancelled:
+			message = "Cancelled";
+			break;
+		case SignatureReadLimitExceeded:
+			message = "Read too much of the file";
+			break;
+		default:
+			break;
+	}
+
+	return message;
+}
+
+bool IsAudioFile(const std::filesystem::path& path)
+{
+	static const char* extensions[] =
+	{
+		".aac", ".aif", ".aiff", ".alac", ".ape", ".flac", ".m4a", ".m4b",
+		".mka", ".mp2", ".mp3", ".mp4", ".mpc", ".oga", ".ogg", ".opus",
+		".wav", ".wma", ".wv"
+	};
+
+	bool isAudio = false;
+
+	std::string extension = path.extension().string();
 
-		if (appdata)
+	std::transform(
+		extension.begin(),
+		extension.end(),
+		extension.begin(),
+		[](unsigned char character)
 		{
-			std::filesystem::path path = appdata;
-			path /= "DigitalZenWorks\\MusicManager\\sakura.mp4";
+			return static_cast<char>(std::tolower(character));
+		});
 
-			tempPath = path.string();
-			dataPath = tempPath.c_str();
+	for (const char* audioExtension : extensions)
+	{
+		if (extension == audioExtension)
+		{
+			isAudio = true;
+			break;
+		}
+	}
+
+	return isAudio;
+}
+
+std::string JsonEscape(const std::string& text)
+{
+	std::string escaped;
+	escaped.reserve(text.size());
+
+	for (char character : text)
+	{
+		switch (character)
+		{
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\b':
+				escaped += "\\b";
+				break;
+			case '\f':
+				escaped += "\\f";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			case '\r':
+				escaped += "\\r";
+				break;
+			case '\t':
+				escaped += "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20)
+				{
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04x", character);
+					escaped += buffer;
+				}
+				else
+				{
+					escaped += character;
+				}
+				break;
 		}
 	}
 
-	std::cout << dataPath << std::endl << std::endl;
+	return escaped;
+}
 
-	char* result = GetAudioSignature(dataPath);
+bool ParseArguments(int argc, char** argv, ScanOptions& options)
+{
+	bool result = true;
 
-	if (result != nullptr)
+	for (int index = 1; index < argc && result == true; index++)
 	{
-		if (minimal == false)
+		std::string argument = argv[index];
+
+		if (argument == "--all")
+		{
+			options.allFiles = true;
+		}
+		else if (argument == "--decoder-threads" && index + 1 < argc)
+		{
+			index++;
+			options.decoderThreads = std::atoi(argv[index]);
+			result = options.decoderThreads >= 0;
+		}
+		else if (argument == "--fast")
 		{
-			std::cout << "AudioSignature: " << result <<
-				std::endl << std::endl << std::endl;
+			options.fastResampling = true;
+		}
+		else if (argument == "--length" && index + 1 < argc)
+		{
+			index++;
+			options.maxDuration = std::atoi(argv[index]);
+			result = options.maxDuration >= 0;
+		}
+		else if (argument == "--probe")
+		{
+			options.probe = true;
+		}
+		else if (argument == "--stats")
+		{
+			options.showStats = true;
+		}
+		else if (argument == "--threads" && index + 1 < argc)
+		{
+			index++;
+			options.threadCount = std::atoi(argv[index]);
+			result = options.threadCount >= 0;
+		}
+		else if (argument == "--timeout" && index + 1 < argc)
+		{
+			index++;
+			options.timeout = std::atof(argv[index]);
+			result = options.timeout >= 0.0;
+		}
+		else if (argument.starts_with("-"))
+		{
+			result = false;
 		}
 		else
 		{
-			std::cout << result << std::endl << std::endl << std::endl;
+			options.paths.push_back(argument);
 		}
 	}
+
+	return result;
+}
+
+std::string ProbeFile(const std::string& filePath, int& status)
+{
+	std::string fields;
+	AudioProbe probe;
+
+	status = ProbeAudioFile(filePath.c_str(), &probe);
+
+	if (status == SignatureSuccess)
+	{
+		fields += ",\"codec\":\"" + JsonEscape(probe.codec) + "\"";
+		fields += ",\"lossless\":";
+		fields += probe.lossless != 0 ? "true" : "false";
+		fields += ",\"sampleRate\":" + std::to_string(probe.sampleRate);
+		fields += ",\"bitsPerSample\":" +
+			std::to_string(probe.bitsPerSample);
+		fields += ",\"channels\":" + std::to_string(probe.channels);
+		fields += ",\"duration\":" + FormatNumber(probe.duration);
+		fields += ",\"bitRate\":" + std::to_string(probe.bitRate);
+	}
+
+	return fields;
+}
+
+size_t ScanFiles(
+	const std::vector<std::filesystem::path>& files,
+	const ScanOptions& options)
+{
+	std::atomic<size_t> failureCount = 0;
+	std::atomic<size_t> nextIndex = 0;
+	std::mutex outputMutex;
+
+	SignatureOptions signatureOptions;
+	GetDefaultSignatureOptions(&signatureOptions);
+	signatureOptions.maxDuration = options.maxDuration;
+	signatureOptions.decoderThreads = options.decoderThreads;
+	signatureOptions.timeout = options.timeout;
+
+	if (options.fastResampling == true)
+	{
+		signatureOptions.resampleMode = SignatureResampleFast;
+	}
+
+	// Each worker keeps one session for all of its files, and pulls the
+	// next unclaimed file until none are left.  The whole stream is taken
+	// as a single chunk.
+	auto worker = [&]()
+	{
+		SignatureSession* session = CreateSignatureSession();
+		SignatureSessionSetOptions(session, &signatureOptions);
+
+		size_t index = nextIndex++;
+
+		while (index < files.size())
+		{
+			const std::filesystem::path& path = files[index];
+			std::string filePath = path.string();
+
+			auto start = std::chrono::steady_clock::now();
+
+			SignatureChunk* chunks = nullptr;
+			size_t count = 0;
+			int status = SignatureSuccess;
+			std::string fields;
+
+			if (options.probe == true)
+			{
+				fields = ProbeFile(filePath, status);
+			}
+			else
+			{
+				status = SignatureSessionRunChunks(
+					session, filePath.c_str(), &chunks, &count);
+			}
+
+			std::chrono::duration<double, std::milli> elapsed =
+				std::chrono::steady_clock::now() - start;
+
+			std::u8string pathText = path.u8string();
+			std::string line = "{\"path\":\"" +
+				JsonEscape(std::string(pathText.begin(), pathText.end())) +
+				"\"";
+
+			if (status == SignatureSuccess && options.probe == true)
+			{
+				line += fields;
+			}
+			else if (status == SignatureSuccess && count > 0)
+			{
+				// As fpcalc, the duration is the file's, from its headers,
+				// rather than the length fingerprinted, which is capped
+				// at --length.  The session still has the file open, so
+				// it is not opened again.
+				double duration = SignatureSessionGetDuration(session);
+
+				if (duration > 0.0)
+				{
+					line += ",\"duration\":" + FormatNumber(duration);
+				}
+
+				line += ",\"fingerprint\":\"";
+				line += chunks[0].audioSignature;
+				line += "\"";
+			}
+			else
+			{
+				line += ",\"error\":\"" + GetStatusMessage(status) + "\"";
+				failureCount++;
+			}
+
+			line += ",\"milliseconds\":" + FormatNumber(elapsed.count());
+			line += "}\n";
+
+			FreeAudioSignatureChunks(chunks, count);
+
+			{
+				std::lock_guard<std::mutex> lock(outputMutex);
+
+				std::cout << line << std::flush;
+			}
+
+			index = nextIndex++;
+		}
+
+		DestroySignatureSession(session);
+	};
+
+	size_t workerCount = static_cast<size_t>(options.threadCount);
+
+	if (workerCount == 0)
+	{
+		workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	workerCount = std::min(workerCount, std::max<size_t>(files.size(), 1));
+
+	std::vector<std::thread> workers;
+	workers.reserve(workerCount);
+
+	for (size_t index = 0; index < workerCount; index++)
+	{
+		workers.emplace_back(worker);
+	}
+
+	for (std::thread& thread : workers)
+	{
+		thread.join();
+	}
+
+	return failureCount;
+}
+
+void ShowHelp()
+{
+	std::cerr <<
+		"Usage: NativeTestConsole [options] path...\n"
+		"\n"
+		"Fingerprints each file given, and every audio file under each\n"
+		"directory given, writing one JSON object per file to stdout.\n"
+		"\n"
+		"Options:\n"
+		"  --all           Fingerprint every file, not only audio files\n"
+		"  --decoder-threads N\n"
+		"                  Threads per decoder, or 0 for FFmpeg's choice (1)\n"
+		"  --fast          Use the fast resampler for 44.1 and 48 kHz audio\n"
+		"  --length SECS   Seconds of audio to use, or 0 for all (120)\n"
+		"  --probe         Read each file's format from its headers only\n"
+		"  --stats         Show the time spent in each stage, per codec\n"
+		"  --threads N     Worker threads, or 0 for one per processor (0)\n"
+		"  --timeout SECS  Seconds to allow each file, or 0 for no limit (0)\n";
+}
+
+void ShowStats()
+{
+	size_t count = 0;
+	GetAudioSignatureStats(nullptr, 0, &count);
+
+	std::vector<SignatureStats> stats(count);
+	GetAudioSignatureStats(stats.data(), stats.size(), &count);
+
+	// The times are summed over all worker threads, so can exceed the
+	// elapsed time.
+	std::cerr << "codec\tfiles\taudio\topen\tdecode\tresample\t" <<
+		"fingerprint\tfinish" << std::endl;
+
+	for (size_t index = 0; index < count; index++)
+	{
+		const SignatureStats& codec = stats[index];
+
+		std::cerr << codec.codec << "\t" << codec.files << "\t" <<
+			FormatNumber(codec.audioSeconds) << "\t" <<
+			FormatNumber(codec.openSeconds) << "\t" <<
+			FormatNumber(codec.decodeSeconds) << "\t" <<
+			FormatNumber(codec.resampleSeconds) << "\t" <<
+			FormatNumber(codec.fingerprintSeconds) << "\t" <<
+			FormatNumber(codec.finishSeconds) << std::endl;
+	}
 }